@@ -0,0 +1,45 @@
+#ifndef GREGJM_ADDRESS_RANGE_HPP
+#define GREGJM_ADDRESS_RANGE_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::MemoryBlock
+
+#include <cstdint> // std::uintptr_t
+#include <type_traits> // std::false_type, std::is_same, std::void_t
+#include <utility> // std::declval
+
+namespace gregjm {
+namespace detail {
+
+template <typename Allocator, typename = void>
+struct HasAddressRange : std::false_type { };
+
+template <typename Allocator>
+struct HasAddressRange<
+    Allocator,
+    std::void_t<decltype(std::declval<const Allocator&>().address_range())>
+> : std::is_same<
+    decltype(std::declval<const Allocator&>().address_range()), MemoryBlock
+> { };
+
+} // namespace detail
+
+// true if every block Allocator hands out lies within the fixed range
+// returned by its address_range() member, meaning that the allocator a block
+// came from can be told from the block's pointer alone
+template <typename Allocator>
+inline constexpr bool has_address_range_v =
+    detail::HasAddressRange<Allocator>::value;
+
+// one subtraction and one comparison; addresses below range.memory wrap
+// around to something larger than range.size
+inline bool in_address_range(const MemoryBlock range,
+                             const void *const memory) noexcept {
+    const auto address = reinterpret_cast<std::uintptr_t>(memory);
+    const auto base = reinterpret_cast<std::uintptr_t>(range.memory);
+
+    return address - base < range.size;
+}
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef GREGJM_ARENA_STACK_HPP
+#define GREGJM_ARENA_STACK_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "address_range.hpp" // gregjm::in_address_range
+
+#include <algorithm> // std::min
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
+#include <cstring> // std::memcpy
+
+namespace gregjm {
+namespace detail {
+
+// for arenas whose memory is usable all the way up front
+struct NoGrow {
+    constexpr inline void operator()(const std::size_t) const noexcept { }
+};
+
+// the bookkeeping shared by the stack-style arenas over a range of memory:
+// a top that advances as blocks are allocated and retreats when the top
+// block is freed, and a count of live blocks that resets the stack once
+// they're all freed. it doesn't lock and doesn't own the memory
+//
+// before the top moves, grow(top) is called with where it's going, so an
+// arena can commit memory or track what's been touched. if grow throws,
+// nothing has changed
+class ArenaStack {
+public:
+    ArenaStack() noexcept = default;
+
+    ArenaStack(std::uint8_t *const memory, const std::size_t capacity) noexcept
+    : memory_{ memory }, capacity_{ capacity } { }
+
+    template <typename Grow = NoGrow>
+    MemoryBlock allocate(const std::size_t size, const std::size_t alignment,
+                         Grow &&grow = Grow{ }) {
+        const auto address = reinterpret_cast<std::uintptr_t>(memory_ + top_);
+        const std::size_t padding =
+            (alignment == 0) ? 0 : (alignment - address % alignment)
+                                   % alignment;
+
+        if (padding > capacity_ - top_ or size > capacity_ - top_ - padding) {
+            throw BadAllocationException{ };
+        }
+
+        const std::size_t offset = top_ + padding;
+        grow(offset + size);
+        top_ = offset + size;
+        ++allocated_;
+
+        return MemoryBlock{ memory_ + offset, size };
+    }
+
+    // the top block grows or shrinks in place; any other block is copied to
+    // a new one
+    template <typename Grow = NoGrow>
+    MemoryBlock reallocate(const MemoryBlock block, const std::size_t size,
+                           const std::size_t alignment, Grow &&grow = Grow{ }) {
+        if (not owns(block)) {
+            throw NotOwnedException{ };
+        }
+
+        const std::size_t offset = offset_of(block);
+
+        if (offset + block.size == top_ and is_aligned(block, alignment)) {
+            if (size > capacity_ - offset) {
+                throw BadAllocationException{ };
+            }
+
+            grow(offset + size);
+            top_ = offset + size;
+
+            return MemoryBlock{ block.memory, size };
+        }
+
+        const MemoryBlock realloc_block = allocate(size, alignment, grow);
+        std::memcpy(realloc_block.memory, block.memory,
+                    std::min(size, block.size));
+        deallocate(block);
+
+        return realloc_block;
+    }
+
+    void deallocate(const MemoryBlock block) {
+        if (not owns(block)) {
+            throw NotOwnedException{ };
+        }
+
+        if (offset_of(block) + block.size == top_) {
+            top_ = offset_of(block);
+        }
+
+        --allocated_;
+
+        if (allocated_ == 0) {
+            top_ = 0;
+        }
+    }
+
+    void reset() noexcept {
+        top_ = 0;
+        allocated_ = 0;
+    }
+
+    bool owns(const MemoryBlock block) const noexcept {
+        return in_address_range(MemoryBlock{ memory_, top_ }, block.memory);
+    }
+
+    std::size_t offset_of(const MemoryBlock block) const noexcept {
+        return static_cast<std::size_t>(
+            static_cast<std::uint8_t*>(block.memory) - memory_
+        );
+    }
+
+    std::uint8_t* memory() const noexcept {
+        return memory_;
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    std::size_t top() const noexcept {
+        return top_;
+    }
+
+    std::size_t max_size() const noexcept {
+        return capacity_ - top_;
+    }
+
+private:
+    static bool is_aligned(const MemoryBlock block,
+                           const std::size_t alignment) noexcept {
+        return alignment == 0
+               or reinterpret_cast<std::uintptr_t>(block.memory)
+                  % alignment == 0;
+    }
+
+    std::uint8_t *memory_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t top_ = 0;
+    std::size_t allocated_ = 0;
+};
+
+} // namespace detail
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef GREGJM_BOUNDED_HEAP_HPP
+#define GREGJM_BOUNDED_HEAP_HPP
+
+#include "fibonacci_heap.hpp" // gregjm::FibonacciHeap
+
+#include <cstddef> // std::size_t
+#include <functional> // std::less, std::invoke
+#include <memory> // std::allocator
+#include <type_traits> // std::is_nothrow_swappable_v
+#include <utility> // std::move, std::forward, std::swap
+
+namespace gregjm {
+namespace detail {
+
+template <typename Compare>
+struct ReverseCompare {
+    template <typename L, typename R>
+    bool operator()(L &&lhs, R &&rhs) const {
+        return std::invoke(compare, std::forward<R>(rhs),
+                           std::forward<L>(lhs));
+    }
+
+    Compare compare;
+};
+
+} // namespace detail
+
+// keeps the best capacity elements pushed to it, best meaning the ones that
+// would come out of a FibonacciHeap<T, Compare> first, so the greatest with
+// std::less. the kept elements sit in a heap with the worst on top: a push
+// is turned away with one comparison against it, or takes its place in its
+// node, so a stream of any length runs in the memory of capacity elements
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = std::allocator<T>>
+class BoundedHeap {
+    using HeapT = FibonacciHeap<T, detail::ReverseCompare<Compare>, Allocator>;
+
+public:
+    using value_compare = Compare;
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using iterator = typename HeapT::iterator;
+    using const_iterator = typename HeapT::const_iterator;
+
+    explicit BoundedHeap(const size_type capacity,
+                         const value_compare &comparator = value_compare{ },
+                         const allocator_type &allocator = allocator_type{ })
+    : heap_{ detail::ReverseCompare<Compare>{ comparator }, allocator },
+      comparator_{ comparator }, capacity_{ capacity } { }
+
+    BoundedHeap(const size_type capacity, const allocator_type &allocator)
+    : BoundedHeap{ capacity, value_compare{ }, allocator } { }
+
+    BoundedHeap(BoundedHeap &&other) = default;
+
+    allocator_type get_allocator() const noexcept {
+        return heap_.get_allocator();
+    }
+
+    // the kept elements in no particular order
+    const_iterator begin() const noexcept {
+        return heap_.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return heap_.end();
+    }
+
+    // the kept element that the next one pushed has to beat
+    const_reference worst() const {
+        return heap_.top();
+    }
+
+    bool empty() const noexcept {
+        return heap_.empty();
+    }
+
+    bool full() const noexcept {
+        return heap_.size() == capacity_;
+    }
+
+    size_type size() const noexcept {
+        return heap_.size();
+    }
+
+    size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    void clear() noexcept {
+        heap_.clear();
+    }
+
+    // returns whether value was kept. once the heap is full, value has to
+    // beat the worst element, which it replaces; ties keep the old one
+    bool push(const value_type &value) {
+        return push_impl(value);
+    }
+
+    bool push(value_type &&value) {
+        return push_impl(std::move(value));
+    }
+
+    // moves the kept elements to out from worst to best and empties the
+    // heap
+    template <typename OutputIterator>
+    OutputIterator drain(const OutputIterator out) {
+        return heap_.pop_k(heap_.size(), out);
+    }
+
+    void swap(BoundedHeap &other)
+    noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+
+        heap_.swap(other.heap_);
+        swap(comparator_, other.comparator_);
+        swap(capacity_, other.capacity_);
+    }
+
+private:
+    template <typename U>
+    bool push_impl(U &&value) {
+        if (heap_.size() < capacity_) {
+            heap_.push(std::forward<U>(value));
+
+            return true;
+        }
+
+        if (capacity_ == 0
+            or not std::invoke(comparator_, heap_.top(), value)) {
+            return false;
+        }
+
+        heap_.replace_top(std::forward<U>(value));
+
+        return true;
+    }
+
+    HeapT heap_;
+    Compare comparator_;
+    size_type capacity_;
+};
+
+template <typename T, typename Compare, typename Allocator>
+void swap(BoundedHeap<T, Compare, Allocator> &lhs,
+          BoundedHeap<T, Compare, Allocator> &rhs)
+noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef GREGJM_COMPACT_HANDLE_HPP
+#define GREGJM_COMPACT_HANDLE_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::MemoryBlock,
+                                     // gregjm::NotOwnedException
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t, std::ptrdiff_t, std::nullptr_t
+#include <cstdint> // std::uint32_t, std::int32_t, std::uintptr_t,
+                   // std::intptr_t
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::add_lvalue_reference_t, std::enable_if_t,
+                       // std::is_convertible_v
+
+namespace gregjm {
+
+// a MemoryBlock stored as an offset from the start of an arena of at most
+// 4 GiB, such as a StackAllocator's address_range(). half the size of a
+// MemoryBlock
+struct CompactBlock {
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+inline bool operator==(const CompactBlock lhs,
+                       const CompactBlock rhs) noexcept {
+    return (lhs.offset == rhs.offset) and (lhs.size == rhs.size);
+}
+
+inline bool operator!=(const CompactBlock lhs,
+                       const CompactBlock rhs) noexcept {
+    return (lhs.offset != rhs.offset) or (lhs.size != rhs.size);
+}
+
+// throws NotOwnedException if block doesn't lie entirely within arena or
+// doesn't fit in 32 bits
+inline CompactBlock compress(const MemoryBlock arena, const MemoryBlock block) {
+    const auto base = reinterpret_cast<std::uintptr_t>(arena.memory);
+    const auto address = reinterpret_cast<std::uintptr_t>(block.memory);
+    constexpr std::uintptr_t MAX = std::numeric_limits<std::uint32_t>::max();
+
+    if (address < base or address - base > arena.size
+        or block.size > arena.size - (address - base)
+        or address - base > MAX or block.size > MAX) {
+        throw NotOwnedException{ };
+    }
+
+    return CompactBlock{ static_cast<std::uint32_t>(address - base),
+                         static_cast<std::uint32_t>(block.size) };
+}
+
+inline MemoryBlock expand(const MemoryBlock arena,
+                          const CompactBlock block) noexcept {
+    assert(block.offset <= arena.size);
+    assert(block.size <= arena.size - block.offset);
+
+    auto *const base = static_cast<unsigned char*>(arena.memory);
+
+    return MemoryBlock{ base + block.offset, block.size };
+}
+
+// a 32-bit pointer that stores the distance from itself to what it points
+// to, so it stays valid when the arena containing both is moved or mapped
+// somewhere else and needs no arena base to dereference. the pointee must be
+// within 2 GiB of the OffsetPtr. an offset of 1 means nullptr, since that
+// would point into the OffsetPtr itself
+//
+// an OffsetPtr is only meant to live next to its pointee. arithmetic and
+// post-increment return a T*, and operands are taken by reference, with
+// overloads for raw pointers, so that no OffsetPtr is made on the stack,
+// where the offset might not fit
+template <typename T>
+class OffsetPtr {
+public:
+    template <typename U>
+    friend class OffsetPtr;
+
+    using element_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::add_lvalue_reference_t<T>;
+
+    OffsetPtr() noexcept = default;
+
+    OffsetPtr(std::nullptr_t) noexcept { }
+
+    OffsetPtr(T *const pointer) noexcept {
+        set(pointer);
+    }
+
+    OffsetPtr(const OffsetPtr &other) noexcept {
+        set(other.get());
+    }
+
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    OffsetPtr(const OffsetPtr<U> &other) noexcept {
+        set(other.get());
+    }
+
+    OffsetPtr& operator=(const OffsetPtr &other) noexcept {
+        set(other.get());
+
+        return *this;
+    }
+
+    OffsetPtr& operator=(T *const pointer) noexcept {
+        set(pointer);
+
+        return *this;
+    }
+
+    OffsetPtr& operator=(std::nullptr_t) noexcept {
+        offset_ = NULL_OFFSET;
+
+        return *this;
+    }
+
+    T* get() const noexcept {
+        if (offset_ == NULL_OFFSET) {
+            return nullptr;
+        }
+
+        return reinterpret_cast<T*>(self() + offset_);
+    }
+
+    reference operator*() const noexcept {
+        assert(get());
+
+        return *get();
+    }
+
+    T* operator->() const noexcept {
+        assert(get());
+
+        return get();
+    }
+
+    reference operator[](const difference_type index) const noexcept {
+        return get()[index];
+    }
+
+    explicit operator bool() const noexcept {
+        return offset_ != NULL_OFFSET;
+    }
+
+    OffsetPtr& operator+=(const difference_type count) noexcept {
+        set(get() + count);
+
+        return *this;
+    }
+
+    OffsetPtr& operator-=(const difference_type count) noexcept {
+        set(get() - count);
+
+        return *this;
+    }
+
+    OffsetPtr& operator++() noexcept {
+        return *this += 1;
+    }
+
+    T* operator++(int) noexcept {
+        T *const previous = get();
+        ++(*this);
+
+        return previous;
+    }
+
+    OffsetPtr& operator--() noexcept {
+        return *this -= 1;
+    }
+
+    T* operator--(int) noexcept {
+        T *const previous = get();
+        --(*this);
+
+        return previous;
+    }
+
+    friend T* operator+(const OffsetPtr &pointer,
+                        const difference_type count) noexcept {
+        return pointer.get() + count;
+    }
+
+    friend T* operator+(const difference_type count,
+                        const OffsetPtr &pointer) noexcept {
+        return pointer.get() + count;
+    }
+
+    friend T* operator-(const OffsetPtr &pointer,
+                        const difference_type count) noexcept {
+        return pointer.get() - count;
+    }
+
+    friend difference_type operator-(const OffsetPtr &lhs,
+                                     const OffsetPtr &rhs) noexcept {
+        return lhs.get() - rhs.get();
+    }
+
+    friend difference_type operator-(const OffsetPtr &lhs,
+                                     const T *const rhs) noexcept {
+        return lhs.get() - rhs;
+    }
+
+    friend difference_type operator-(const T *const lhs,
+                                     const OffsetPtr &rhs) noexcept {
+        return lhs - rhs.get();
+    }
+
+    friend bool operator==(const OffsetPtr &lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs.get() == rhs.get();
+    }
+
+    friend bool operator!=(const OffsetPtr &lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs.get() != rhs.get();
+    }
+
+    friend bool operator==(const OffsetPtr &lhs,
+                           const T *const rhs) noexcept {
+        return lhs.get() == rhs;
+    }
+
+    friend bool operator==(const T *const lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs == rhs.get();
+    }
+
+    friend bool operator!=(const OffsetPtr &lhs,
+                           const T *const rhs) noexcept {
+        return lhs.get() != rhs;
+    }
+
+    friend bool operator!=(const T *const lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs != rhs.get();
+    }
+
+    friend bool operator<(const OffsetPtr &lhs,
+                          const OffsetPtr &rhs) noexcept {
+        return lhs.get() < rhs.get();
+    }
+
+    friend bool operator<(const OffsetPtr &lhs,
+                          const T *const rhs) noexcept {
+        return lhs.get() < rhs;
+    }
+
+    friend bool operator<(const T *const lhs,
+                          const OffsetPtr &rhs) noexcept {
+        return lhs < rhs.get();
+    }
+
+    friend bool operator<=(const OffsetPtr &lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs.get() <= rhs.get();
+    }
+
+    friend bool operator<=(const OffsetPtr &lhs,
+                           const T *const rhs) noexcept {
+        return lhs.get() <= rhs;
+    }
+
+    friend bool operator<=(const T *const lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs <= rhs.get();
+    }
+
+    friend bool operator>(const OffsetPtr &lhs,
+                          const OffsetPtr &rhs) noexcept {
+        return lhs.get() > rhs.get();
+    }
+
+    friend bool operator>(const OffsetPtr &lhs,
+                          const T *const rhs) noexcept {
+        return lhs.get() > rhs;
+    }
+
+    friend bool operator>(const T *const lhs,
+                          const OffsetPtr &rhs) noexcept {
+        return lhs > rhs.get();
+    }
+
+    friend bool operator>=(const OffsetPtr &lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs.get() >= rhs.get();
+    }
+
+    friend bool operator>=(const OffsetPtr &lhs,
+                           const T *const rhs) noexcept {
+        return lhs.get() >= rhs;
+    }
+
+    friend bool operator>=(const T *const lhs,
+                           const OffsetPtr &rhs) noexcept {
+        return lhs >= rhs.get();
+    }
+
+private:
+    static constexpr std::int32_t NULL_OFFSET = 1;
+
+    std::intptr_t self() const noexcept {
+        return reinterpret_cast<std::intptr_t>(this);
+    }
+
+    void set(T *const pointer) noexcept {
+        if (not pointer) {
+            offset_ = NULL_OFFSET;
+
+            return;
+        }
+
+        const std::intptr_t offset =
+            reinterpret_cast<std::intptr_t>(pointer) - self();
+
+        assert(offset >= std::numeric_limits<std::int32_t>::min());
+        assert(offset <= std::numeric_limits<std::int32_t>::max());
+        assert(offset != NULL_OFFSET);
+
+        offset_ = static_cast<std::int32_t>(offset);
+    }
+
+    std::int32_t offset_ = NULL_OFFSET;
+};
+
+} // namespace gregjm
+
+#endif
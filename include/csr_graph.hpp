@@ -0,0 +1,433 @@
+#ifndef GREGJM_CSR_GRAPH_HPP
+#define GREGJM_CSR_GRAPH_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::PolymorphicAllocatorAdaptor
+
+#include <algorithm> // std::max
+#include <charconv> // std::from_chars
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
+#include <optional> // std::optional, std::nullopt
+#include <stdexcept> // std::out_of_range
+#include <system_error> // std::errc
+#include <vector> // std::vector
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h> // CreateFileA, CreateFileMappingW, MapViewOfFile,
+                     // UnmapViewOfFile, GetFileSizeEx, CloseHandle
+#else
+#include <fcntl.h> // open, O_RDONLY, O_CLOEXEC
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#endif
+
+namespace gregjm {
+
+using VertexId = std::uint32_t;
+
+template <typename Weight>
+struct WeightedEdge {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+};
+
+// an edge as seen from its source
+template <typename Weight>
+struct Arc {
+    VertexId target;
+    Weight weight;
+};
+
+// a static directed graph in compressed sparse row form: the arcs leaving
+// each vertex are stored next to each other, ordered by source, so a
+// traversal reads them front to back. storage comes from a
+// PolymorphicAllocator, which must outlive the graph
+template <typename Weight = std::uint32_t>
+class CsrGraph {
+    template <typename T>
+    using VectorT = std::vector<T, PolymorphicAllocatorAdaptor<T>>;
+
+public:
+    using weight_type = Weight;
+    using ArcT = Arc<Weight>;
+    using EdgeT = WeightedEdge<Weight>;
+
+    class ArcRange {
+    public:
+        ArcRange(const ArcT *const first, const ArcT *const last) noexcept
+        : first_{ first }, last_{ last } { }
+
+        const ArcT* begin() const noexcept {
+            return first_;
+        }
+
+        const ArcT* end() const noexcept {
+            return last_;
+        }
+
+        std::size_t size() const noexcept {
+            return static_cast<std::size_t>(last_ - first_);
+        }
+
+    private:
+        const ArcT *first_;
+        const ArcT *last_;
+    };
+
+    // builds the graph from a range of WeightedEdges, which is read twice.
+    // undirected graphs store each edge once in each direction. throws
+    // std::out_of_range if an edge names a vertex >= num_vertices
+    template <typename Iterator>
+    CsrGraph(const VertexId num_vertices, const Iterator first,
+             const Iterator last, PolymorphicAllocator &alloc,
+             const bool undirected = false)
+    : offsets_(static_cast<std::size_t>(num_vertices) + 1, 0,
+               make_adaptor<std::size_t>(alloc)),
+      arcs_{ make_adaptor<ArcT>(alloc) } {
+        // counting sort: count each source's arcs, then place them
+        for (Iterator iter = first; iter != last; ++iter) {
+            const EdgeT &edge = *iter;
+
+            if (edge.from >= num_vertices or edge.to >= num_vertices) {
+                throw std::out_of_range{ "CsrGraph: vertex out of range" };
+            }
+
+            ++offsets_[edge.from + 1];
+
+            if (undirected) {
+                ++offsets_[edge.to + 1];
+            }
+        }
+
+        for (std::size_t i = 1; i < offsets_.size(); ++i) {
+            offsets_[i] += offsets_[i - 1];
+        }
+
+        arcs_.resize(offsets_.back());
+        VectorT<std::size_t> next(offsets_.cbegin(), offsets_.cend() - 1,
+                                  make_adaptor<std::size_t>(alloc));
+
+        for (Iterator iter = first; iter != last; ++iter) {
+            const EdgeT &edge = *iter;
+
+            arcs_[next[edge.from]++] = ArcT{ edge.to, edge.weight };
+
+            if (undirected) {
+                arcs_[next[edge.to]++] = ArcT{ edge.from, edge.weight };
+            }
+        }
+    }
+
+    VertexId num_vertices() const noexcept {
+        return static_cast<VertexId>(offsets_.size() - 1);
+    }
+
+    std::size_t num_arcs() const noexcept {
+        return arcs_.size();
+    }
+
+    ArcRange arcs(const VertexId vertex) const noexcept {
+        return ArcRange{ arcs_.data() + offsets_[vertex],
+                         arcs_.data() + offsets_[vertex + 1] };
+    }
+
+    std::size_t degree(const VertexId vertex) const noexcept {
+        return offsets_[vertex + 1] - offsets_[vertex];
+    }
+
+private:
+    VectorT<std::size_t> offsets_;
+    VectorT<ArcT> arcs_;
+};
+
+namespace detail {
+
+// a read-only view of a whole file; empty if it couldn't be mapped
+class MappedFile {
+public:
+    explicit MappedFile(const char *const path) noexcept {
+#if defined(_WIN32)
+        const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ,
+                                        nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+
+        if (GetFileSizeEx(file, &size) and size.QuadPart > 0) {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY,
+                                         0, 0, nullptr);
+        }
+
+        if (mapping) {
+            data_ = static_cast<const char*>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+            );
+            size_ = data_ ? static_cast<std::size_t>(size.QuadPart) : 0;
+
+            // the view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+#else
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat status;
+
+        if (fstat(fd, &status) == 0 and status.st_size > 0) {
+            const auto size = static_cast<std::size_t>(status.st_size);
+            void *const memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                                      fd, 0);
+
+            if (memory != MAP_FAILED) {
+                madvise(memory, size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(memory);
+                size_ = size;
+            }
+        }
+
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile &other) = delete;
+
+    MappedFile& operator=(const MappedFile &other) = delete;
+
+    ~MappedFile() {
+        if (not data_) {
+            return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    const char* begin() const noexcept {
+        return data_;
+    }
+
+    const char* end() const noexcept {
+        return data_ + size_;
+    }
+
+    explicit operator bool() const noexcept {
+        return data_ != nullptr;
+    }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// walks a text file one whitespace-separated field at a time
+class LineParser {
+public:
+    LineParser(const char *const first, const char *const last) noexcept
+    : current_{ first }, last_{ last } { }
+
+    bool done() const noexcept {
+        return current_ == last_;
+    }
+
+    // the first character of the current line's next field, or '\n' at
+    // the end of the line
+    char peek() noexcept {
+        skip_blanks();
+
+        return (current_ == last_) ? '\n' : *current_;
+    }
+
+    template <typename T>
+    bool parse(T &value) noexcept {
+        skip_blanks();
+
+        const auto [end, error] = std::from_chars(current_, last_, value);
+
+        if (error != std::errc{ }) {
+            return false;
+        }
+
+        current_ = end;
+
+        return true;
+    }
+
+    // skips the field at the start of the line, which must be tag
+    bool expect(const char tag) noexcept {
+        if (peek() != tag) {
+            return false;
+        }
+
+        ++current_;
+
+        return true;
+    }
+
+    void next_line() noexcept {
+        while (current_ != last_ and *current_ != '\n') {
+            ++current_;
+        }
+
+        if (current_ != last_) {
+            ++current_;
+        }
+    }
+
+private:
+    void skip_blanks() noexcept {
+        while (current_ != last_
+               and (*current_ == ' ' or *current_ == '\t'
+                    or *current_ == '\r')) {
+            ++current_;
+        }
+    }
+
+    const char *current_;
+    const char *last_;
+};
+
+} // namespace detail
+
+// loads a graph in the DIMACS shortest path format: a "p sp <vertices>
+// <arcs>" line, then one "a <from> <to> <weight>" line per arc, with
+// vertices numbered from 1 and "c" lines as comments. the result is empty
+// if the file can't be read or doesn't parse
+template <typename Weight = std::uint32_t>
+std::optional<CsrGraph<Weight>> load_dimacs(const char *const path,
+                                            PolymorphicAllocator &alloc,
+                                            const bool undirected = false) {
+    using EdgeT = WeightedEdge<Weight>;
+
+    const detail::MappedFile file{ path };
+
+    if (not file) {
+        return std::nullopt;
+    }
+
+    detail::LineParser parser{ file.begin(), file.end() };
+    std::vector<EdgeT, PolymorphicAllocatorAdaptor<EdgeT>> edges{
+        make_adaptor<EdgeT>(alloc)
+    };
+    VertexId num_vertices = 0;
+    bool has_problem = false;
+
+    for (; not parser.done(); parser.next_line()) {
+        switch (parser.peek()) {
+        case 'p': {
+            std::size_t num_arcs;
+
+            if (has_problem or not parser.expect('p')
+                or not parser.expect('s') or not parser.expect('p')
+                or not parser.parse(num_vertices)
+                or not parser.parse(num_arcs)) {
+                return std::nullopt;
+            }
+
+            has_problem = true;
+            edges.reserve(num_arcs);
+
+            break;
+        }
+        case 'a': {
+            EdgeT edge;
+
+            if (not has_problem or not parser.expect('a')
+                or not parser.parse(edge.from) or not parser.parse(edge.to)
+                or not parser.parse(edge.weight)
+                or edge.from == 0 or edge.from > num_vertices
+                or edge.to == 0 or edge.to > num_vertices) {
+                return std::nullopt;
+            }
+
+            --edge.from;
+            --edge.to;
+            edges.push_back(edge);
+
+            break;
+        }
+        case 'c':
+        case '\n':
+            break;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    if (not has_problem) {
+        return std::nullopt;
+    }
+
+    return CsrGraph<Weight>{ num_vertices, edges.cbegin(), edges.cend(),
+                             alloc, undirected };
+}
+
+// loads a graph with one "<from> <to> [weight]" line per edge, with
+// vertices numbered from 0 and lines starting with '#' or '%' as comments.
+// missing weights are 1 and the graph has as many vertices as it needs.
+// the result is empty if the file can't be read or doesn't parse
+template <typename Weight = std::uint32_t>
+std::optional<CsrGraph<Weight>> load_edge_list(const char *const path,
+                                               PolymorphicAllocator &alloc,
+                                               const bool undirected = false) {
+    using EdgeT = WeightedEdge<Weight>;
+
+    const detail::MappedFile file{ path };
+
+    if (not file) {
+        return std::nullopt;
+    }
+
+    detail::LineParser parser{ file.begin(), file.end() };
+    std::vector<EdgeT, PolymorphicAllocatorAdaptor<EdgeT>> edges{
+        make_adaptor<EdgeT>(alloc)
+    };
+    VertexId max_vertex = 0;
+
+    for (; not parser.done(); parser.next_line()) {
+        const char first = parser.peek();
+
+        if (first == '#' or first == '%' or first == '\n') {
+            continue;
+        }
+
+        EdgeT edge{ 0, 0, Weight{ 1 } };
+
+        if (not parser.parse(edge.from) or not parser.parse(edge.to)
+            or (parser.peek() != '\n' and not parser.parse(edge.weight))
+            or edge.from == static_cast<VertexId>(-1)
+            or edge.to == static_cast<VertexId>(-1)) {
+            return std::nullopt;
+        }
+
+        max_vertex = std::max({ max_vertex, edge.from, edge.to });
+        edges.push_back(edge);
+    }
+
+    const VertexId num_vertices = edges.empty() ? 0 : max_vertex + 1;
+
+    return CsrGraph<Weight>{ num_vertices, edges.cbegin(), edges.cend(),
+                             alloc, undirected };
+}
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef GREGJM_DIRECT_IO_BUFFER_POOL_HPP
+#define GREGJM_DIRECT_IO_BUFFER_POOL_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "address_range.hpp" // gregjm::in_address_range
+#include "lock_free_free_list.hpp" // gregjm::LockFreeFreeList,
+                                   // gregjm::FreeListChain
+#include "virtual_memory.hpp" // gregjm::map_memory, gregjm::release_memory,
+                              // gregjm::round_to_pages, gregjm::page_size
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::max
+#include <array> // std::array
+#include <atomic> // std::atomic
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
+#include <limits> // std::numeric_limits
+#include <memory> // std::unique_ptr, std::make_unique
+#include <mutex> // std::scoped_lock
+
+#if defined(__linux__)
+#include <fcntl.h> // AT_EMPTY_PATH
+#include <linux/fs.h> // BLKSSZGET
+#include <sys/ioctl.h> // ioctl
+#include <sys/stat.h> // statx, fstat
+#endif
+
+namespace gregjm {
+
+// what O_DIRECT requires of a file: buffers aligned to memory bytes, and
+// file offsets and lengths that are multiples of offset bytes
+struct DirectIoAlignment {
+    std::size_t memory;
+    std::size_t offset;
+};
+
+// asks the kernel for fd's direct I/O alignment: statx's STATX_DIOALIGN
+// where the kernel (6.1+) and filesystem report it, then the logical sector
+// size of block devices, and otherwise assumes 4 KiB, the largest logical
+// block size in common use
+inline DirectIoAlignment direct_io_alignment([[maybe_unused]] const int fd) {
+    constexpr std::size_t FALLBACK = 4096;
+
+#if defined(__linux__)
+#if defined(STATX_DIOALIGN)
+    struct statx stx;
+
+    if (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0
+        and (stx.stx_mask & STATX_DIOALIGN) and stx.stx_dio_mem_align != 0
+        and stx.stx_dio_offset_align != 0) {
+        return DirectIoAlignment{ stx.stx_dio_mem_align,
+                                  stx.stx_dio_offset_align };
+    }
+#endif
+
+    struct stat st;
+    int sector_size = 0;
+
+    if (fstat(fd, &st) == 0 and S_ISBLK(st.st_mode)
+        and ioctl(fd, BLKSSZGET, &sector_size) == 0 and sector_size > 0) {
+        const auto size = static_cast<std::size_t>(sector_size);
+
+        return DirectIoAlignment{ size, size };
+    }
+#endif
+
+    return DirectIoAlignment{ FALLBACK, FALLBACK };
+}
+
+// fixed-size buffers whose addresses and sizes satisfy a DirectIoAlignment.
+// buffers come out of page-aligned chunks that double in size as the pool
+// grows and are never zeroed: fresh chunks are zero pages from the OS and
+// recycled buffers keep whatever was last read into them
+//
+// freed buffers go onto one of several lock-free caches picked by the
+// calling thread, so threads mostly recycle their own buffers without
+// contending; a thread whose cache is empty takes from the others before
+// growing the pool. Mutex only serializes growth, but two threads growing
+// the pool at once need it: with the default DummyMutex, the pool is for
+// one thread. pass std::mutex to share it
+//
+// each buffer has an in-use flag, so a double free or a pointer into the
+// middle of a buffer throws NotOwnedException instead of corrupting the
+// caches
+template <typename Mutex = DummyMutex>
+class DirectIoBufferPool final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+    static constexpr std::size_t NUM_CACHES = 16;
+    static constexpr std::size_t MAX_CHUNKS = 48;
+    static constexpr std::size_t FIRST_CHUNK_BUFFERS = 16;
+
+    struct alignas(64) Cache {
+        LockFreeFreeList buffers;
+    };
+
+    struct Chunk {
+        MemoryBlock mapping;
+        std::uint8_t *first; // aligned
+        std::size_t count;
+        std::unique_ptr<std::atomic<bool>[]> in_use;
+    };
+
+public:
+    // throws BadAllocationException if buffer_size or alignment.offset is 0
+    DirectIoBufferPool(const std::size_t buffer_size,
+                       const DirectIoAlignment alignment)
+    : alignment_{ std::max(alignment.memory, alignment.offset) },
+      buffer_size_{ checked_buffer_size(buffer_size, alignment.offset) },
+      stride_{ round_up(buffer_size_, alignment_) } { }
+
+    // aligns buffers for O_DIRECT I/O on fd
+    DirectIoBufferPool(const std::size_t buffer_size, const int fd)
+    : DirectIoBufferPool{ buffer_size, direct_io_alignment(fd) } { }
+
+    DirectIoBufferPool(const DirectIoBufferPool &other) = delete;
+
+    DirectIoBufferPool& operator=(const DirectIoBufferPool &other) = delete;
+
+    virtual ~DirectIoBufferPool() {
+        const std::size_t num_chunks =
+            num_chunks_.load(std::memory_order_acquire);
+
+        for (std::size_t i = 0; i < num_chunks; ++i) {
+            const MemoryBlock mapping = chunks_[i].mapping;
+            release_memory(mapping.memory, mapping.size);
+        }
+    }
+
+    // every buffer is this many bytes, a multiple of the offset alignment
+    std::size_t buffer_size() const noexcept {
+        return buffer_size_;
+    }
+
+    std::size_t alignment() const noexcept {
+        return alignment_;
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        if (size > buffer_size_ or alignment > alignment_) {
+            throw BadAllocationException{ };
+        }
+
+        const std::size_t home = cache_index();
+
+        for (std::size_t i = 0; i < NUM_CACHES; ++i) {
+            void *const buffer =
+                caches_[(home + i) % NUM_CACHES].buffers.pop();
+
+            if (buffer) {
+                return MemoryBlock{ claim(buffer), size };
+            }
+        }
+
+        return MemoryBlock{ claim(grow(home)), size };
+    }
+
+    // buffers never move; they can only grow up to buffer_size()
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        if (not owns_impl(block)) {
+            throw NotOwnedException{ };
+        }
+
+        if (size > buffer_size_ or alignment > alignment_) {
+            throw BadAllocationException{ };
+        }
+
+        return MemoryBlock{ block.memory, size };
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        std::atomic<bool> *const in_use = in_use_flag(block.memory);
+
+        // of two threads freeing the same buffer, only one clears the flag
+        if (not in_use or not in_use->exchange(false,
+                                               std::memory_order_acq_rel)) {
+            throw NotOwnedException{ };
+        }
+
+        caches_[cache_index()].buffers.push(block.memory);
+    }
+
+    // not safe to call while other threads are using the pool
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        for (Cache &cache : caches_) {
+            cache.buffers.pop_all();
+        }
+
+        const std::size_t num_chunks =
+            num_chunks_.load(std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < num_chunks; ++i) {
+            for (std::size_t j = 0; j < chunks_[i].count; ++j) {
+                chunks_[i].in_use[j].store(false, std::memory_order_relaxed);
+            }
+
+            caches_[i % NUM_CACHES].buffers.push_chain(carve(chunks_[i]));
+        }
+    }
+
+    std::size_t max_size_impl() const override {
+        return buffer_size_;
+    }
+
+    // only buffers that are handed out are owned
+    bool owns_impl(const MemoryBlock block) const override {
+        const std::atomic<bool> *const in_use = in_use_flag(block.memory);
+
+        return in_use and in_use->load(std::memory_order_acquire);
+    }
+
+    // the in-use flag of the buffer starting at memory, or nullptr if no
+    // buffer starts there
+    std::atomic<bool>* in_use_flag(const void *const memory) const noexcept {
+        const std::size_t num_chunks =
+            num_chunks_.load(std::memory_order_acquire);
+
+        for (std::size_t i = 0; i < num_chunks; ++i) {
+            const Chunk &chunk = chunks_[i];
+
+            if (not in_address_range(MemoryBlock{ chunk.first,
+                                                  chunk.count * stride_ },
+                                     memory)) {
+                continue;
+            }
+
+            const auto offset = static_cast<std::size_t>(
+                static_cast<const std::uint8_t*>(memory) - chunk.first
+            );
+
+            if (offset % stride_ != 0) {
+                return nullptr;
+            }
+
+            return &chunk.in_use[offset / stride_];
+        }
+
+        return nullptr;
+    }
+
+    void* claim(void *const buffer) const noexcept {
+        in_use_flag(buffer)->store(true, std::memory_order_release);
+
+        return buffer;
+    }
+
+    // maps a chunk twice the size of the last, keeps one buffer for the
+    // caller and caches the rest
+    void* grow(const std::size_t home) {
+        const LockT lock{ mutex_ };
+
+        // someone else may have grown the pool while we waited
+        if (void *const buffer = caches_[home].buffers.pop()) {
+            return buffer;
+        }
+
+        const std::size_t num_chunks =
+            num_chunks_.load(std::memory_order_relaxed);
+
+        if (num_chunks == MAX_CHUNKS) {
+            throw BadAllocationException{ };
+        }
+
+        const std::size_t num_buffers = FIRST_CHUNK_BUFFERS << num_chunks;
+        constexpr std::size_t MAX_SIZE =
+            std::numeric_limits<std::size_t>::max();
+
+        if (num_buffers > (MAX_SIZE - 2 * alignment_) / stride_) {
+            throw BadAllocationException{ };
+        }
+
+        const std::size_t size = round_to_pages(num_buffers * stride_
+                                                + alignment_);
+        auto *const memory = static_cast<std::uint8_t*>(map_memory(size));
+        auto *const first = static_cast<std::uint8_t*>(align_up(memory));
+        const auto count = static_cast<std::size_t>(memory + size - first)
+                           / stride_;
+        Chunk &chunk = chunks_[num_chunks];
+
+        try {
+            chunk.in_use = std::make_unique<std::atomic<bool>[]>(count);
+        } catch (...) {
+            release_memory(memory, size);
+
+            throw;
+        }
+
+        chunk.mapping = MemoryBlock{ memory, size };
+        chunk.first = first;
+        chunk.count = count;
+        num_chunks_.store(num_chunks + 1, std::memory_order_release);
+
+        FreeListChain chain = carve(chunk);
+        void *const buffer = chain.pop_front();
+        caches_[home].buffers.push_chain(chain);
+
+        return buffer;
+    }
+
+    // links every buffer in chunk into a chain, lowest address first
+    FreeListChain carve(const Chunk &chunk) const noexcept {
+        FreeListChain chain;
+
+        for (std::size_t i = chunk.count; i > 0; --i) {
+            chain.push_front(chunk.first + (i - 1) * stride_);
+        }
+
+        return chain;
+    }
+
+    void* align_up(void *const memory) const noexcept {
+        const auto address = reinterpret_cast<std::uintptr_t>(memory);
+
+        return reinterpret_cast<void*>(round_up(address, alignment_));
+    }
+
+    static std::size_t checked_buffer_size(const std::size_t buffer_size,
+                                           const std::size_t offset) {
+        if (buffer_size == 0 or offset == 0) {
+            throw BadAllocationException{ };
+        }
+
+        return round_up(buffer_size, offset);
+    }
+
+    template <typename T>
+    static T round_up(const T value, const std::size_t multiple) noexcept {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    // threads are spread round-robin over the caches on first use
+    static std::size_t cache_index() noexcept {
+        static std::atomic<std::size_t> next_index{ 0 };
+        static thread_local const std::size_t index =
+            next_index.fetch_add(1, std::memory_order_relaxed) % NUM_CACHES;
+
+        return index;
+    }
+
+    std::size_t alignment_;
+    std::size_t buffer_size_;
+    std::size_t stride_;
+    std::array<Cache, NUM_CACHES> caches_;
+    std::array<Chunk, MAX_CHUNKS> chunks_;
+    std::atomic<std::size_t> num_chunks_{ 0 };
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
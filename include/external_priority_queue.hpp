@@ -0,0 +1,318 @@
+#ifndef GREGJM_EXTERNAL_PRIORITY_QUEUE_HPP
+#define GREGJM_EXTERNAL_PRIORITY_QUEUE_HPP
+
+#if defined(__linux__)
+
+#include "fibonacci_heap.hpp" // gregjm::FibonacciHeap
+#include "polymorphic_allocator.hpp" // gregjm::BadAllocationException
+#include "virtual_memory.hpp" // gregjm::create_temporary_file,
+                              // gregjm::page_size, gregjm::round_to_pages
+
+#include <algorithm> // std::min, std::max, std::push_heap, std::pop_heap
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t
+#include <functional> // std::less, std::invoke
+#include <memory> // std::unique_ptr, std::make_unique
+#include <string> // std::string
+#include <type_traits> // std::is_trivially_copyable_v
+#include <utility> // std::move
+#include <vector> // std::vector
+
+#include <fcntl.h> // posix_fallocate
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <unistd.h> // close
+
+namespace gregjm {
+namespace detail {
+
+// a run of elements spilled to an unlinked file, written once through a
+// shared mapping and then read back in order. the file's space is reserved
+// up front, so a full disk is found before anything is written, and goes
+// away with the mapping
+template <typename T>
+class SpilledRun {
+public:
+    SpilledRun(const std::string &directory, const std::size_t capacity)
+    : size_{ capacity * sizeof(T) } {
+        const int fd = create_temporary_file(directory);
+
+        if (fd < 0) {
+            throw BadAllocationException{ };
+        }
+
+        if (posix_fallocate(fd, 0, static_cast<off_t>(size_)) != 0) {
+            close(fd);
+
+            throw BadAllocationException{ };
+        }
+
+        void *const memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, fd, 0);
+
+        // the mapping keeps the file open
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            throw BadAllocationException{ };
+        }
+
+        data_ = static_cast<T*>(memory);
+    }
+
+    SpilledRun(const SpilledRun &other) = delete;
+
+    SpilledRun& operator=(const SpilledRun &other) = delete;
+
+    ~SpilledRun() {
+        munmap(data_, size_);
+    }
+
+    // where the run is written
+    T* data() noexcept {
+        return data_;
+    }
+
+    // ends writing with the first count elements. the written pages are
+    // dropped from the process's memory, dirty ones being left for the
+    // kernel to write back, and the start of the run is read ahead
+    void seal(const std::size_t count) noexcept {
+        assert(count * sizeof(T) <= size_);
+
+        count_ = count;
+        madvise(data_, size_, MADV_DONTNEED);
+        madvise(data_, size_, MADV_SEQUENTIAL);
+        prefetch();
+    }
+
+    const T& head() const noexcept {
+        assert(position_ < count_);
+
+        return data_[position_];
+    }
+
+    bool exhausted() const noexcept {
+        return position_ == count_;
+    }
+
+    // moves past the head, reading ahead of it and dropping the pages
+    // behind it a window at a time
+    void advance() noexcept {
+        assert(position_ < count_);
+
+        ++position_;
+
+        const std::size_t consumed = position_ * sizeof(T);
+
+        if (consumed + window() > prefetched_) {
+            prefetch();
+        }
+
+        const std::size_t page = page_size();
+        const std::size_t done = consumed / page * page;
+
+        if (done - released_ >= window()) {
+            madvise(bytes() + released_, done - released_, MADV_DONTNEED);
+            released_ = done;
+        }
+    }
+
+private:
+    // asks for the next two windows past the head to be read in
+    void prefetch() noexcept {
+        const std::size_t end = std::min(count_ * sizeof(T),
+                                         position_ * sizeof(T)
+                                         + 2 * window());
+
+        if (prefetched_ < end) {
+            madvise(bytes() + prefetched_, end - prefetched_,
+                    MADV_WILLNEED);
+            prefetched_ = (end + page_size() - 1) / page_size() * page_size();
+        }
+    }
+
+    std::uint8_t* bytes() const noexcept {
+        return reinterpret_cast<std::uint8_t*>(data_);
+    }
+
+    // runs are read ahead and released 1 MiB at a time
+    static std::size_t window() noexcept {
+        return round_to_pages(std::size_t{ 1 } << 20);
+    }
+
+    T *data_ = nullptr;
+    std::size_t size_;
+    std::size_t count_ = 0;
+    std::size_t position_ = 0;
+    std::size_t prefetched_ = 0; // page aligned
+    std::size_t released_ = 0; // page aligned
+};
+
+} // namespace detail
+
+// a priority queue that can outgrow memory. up to capacity elements are
+// kept in a FibonacciHeap; when it's full, its contents are written best
+// first to a run in an unlinked file in directory, which should be on a
+// disk. pops merge the heap with the heads of the runs, each of which is
+// read ahead through its mapping and released behind, so memory use stays
+// around capacity elements plus a few pages per run
+//
+// elements are copied to and from disk as bytes, so T has to be trivially
+// copyable. a push that can't spill throws BadAllocationException and
+// leaves the queue as it was
+template <typename T, typename Compare = std::less<T>>
+class ExternalPriorityQueue {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "T must be trivially copyable to be spilled to disk");
+
+    using RunT = detail::SpilledRun<T>;
+    using RunOwnerT = std::unique_ptr<RunT>;
+
+public:
+    using value_compare = Compare;
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+
+    explicit ExternalPriorityQueue(const size_type capacity,
+                                   std::string directory = "/var/tmp",
+                                   const value_compare &comparator =
+                                       value_compare{ })
+    : memory_{ comparator }, comparator_{ comparator },
+      capacity_{ std::max(capacity, size_type{ 1 }) },
+      directory_{ std::move(directory) } { }
+
+    ExternalPriorityQueue(const ExternalPriorityQueue &other) = delete;
+
+    ExternalPriorityQueue&
+    operator=(const ExternalPriorityQueue &other) = delete;
+
+    const_reference top() const {
+        assert(not empty());
+
+        return top_in_memory() ? memory_.top() : runs_.front()->head();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    size_type size() const noexcept {
+        return memory_.size() + spilled_;
+    }
+
+    // how many elements are on disk
+    size_type spilled() const noexcept {
+        return spilled_;
+    }
+
+    // how many runs still have elements in them
+    size_type runs() const noexcept {
+        return runs_.size();
+    }
+
+    size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    void clear() noexcept {
+        memory_.clear();
+        runs_.clear();
+        spilled_ = 0;
+    }
+
+    void push(const value_type &value) {
+        if (memory_.size() == capacity_) {
+            spill();
+        }
+
+        memory_.push(value);
+    }
+
+    // ties are broken in favor of the element in memory
+    void pop() {
+        assert(not empty());
+
+        if (top_in_memory()) {
+            memory_.pop();
+
+            return;
+        }
+
+        std::pop_heap(runs_.begin(), runs_.end(), run_order());
+        runs_.back()->advance();
+        --spilled_;
+
+        if (runs_.back()->exhausted()) {
+            runs_.pop_back();
+        } else {
+            std::push_heap(runs_.begin(), runs_.end(), run_order());
+        }
+    }
+
+    // writes everything in memory to a new run
+    void spill() {
+        const size_type count = memory_.size();
+
+        if (count == 0) {
+            return;
+        }
+
+        auto run = std::make_unique<RunT>(directory_, count);
+
+        if (runs_.size() == runs_.capacity()) {
+            runs_.reserve(std::max(2 * runs_.size(), size_type{ 1 }));
+        }
+
+        try {
+            memory_.pop_k(count, run->data());
+        } catch (...) {
+            // what was written is sorted and gone from the heap
+            add_run(std::move(run), count - memory_.size());
+
+            throw;
+        }
+
+        add_run(std::move(run), count);
+    }
+
+private:
+    bool top_in_memory() const {
+        return runs_.empty()
+               or (not memory_.empty()
+                   and not std::invoke(comparator_, memory_.top(),
+                                       runs_.front()->head()));
+    }
+
+    // assumes runs_ has room for one more
+    void add_run(RunOwnerT run, const size_type count) {
+        if (count == 0) {
+            return;
+        }
+
+        run->seal(count);
+        spilled_ += count;
+        runs_.push_back(std::move(run));
+        std::push_heap(runs_.begin(), runs_.end(), run_order());
+    }
+
+    // runs_ is a binary heap with the best head first
+    auto run_order() const noexcept {
+        return [this](const RunOwnerT &lhs, const RunOwnerT &rhs) {
+            return std::invoke(comparator_, lhs->head(), rhs->head());
+        };
+    }
+
+    FibonacciHeap<T, Compare> memory_;
+    std::vector<RunOwnerT> runs_;
+    value_compare comparator_;
+    size_type capacity_;
+    size_type spilled_ = 0;
+    std::string directory_;
+};
+
+} // namespace gregjm
+
+#endif
+
+#endif
@@ -4,6 +4,8 @@
 #include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
                                      // gregjm::MemoryBlock,
                                      // gregjm::BadAllocationException
+#include "address_range.hpp" // gregjm::has_address_range_v,
+                             // gregjm::in_address_range
 
 #include <cstring> // std::memcpy
 #include <algorithm> // std::max, std::min
@@ -14,6 +16,8 @@
 
 namespace gregjm {
 
+// if Primary has an address_range(), blocks are routed back by their pointer
+// instead of asking Primary whether it owns them
 template <typename Primary, typename Secondary>
 class FallbackAllocator final : public PolymorphicAllocator {
     using PairT = std::pair<Primary, Secondary>;
@@ -58,7 +62,7 @@ private:
                                 const std::size_t alignment) override {
         const auto min_size = std::min(block.size, size);
 
-        if (primary().owns(block)) {
+        if (from_primary(block)) {
             try {
                 return primary().reallocate(block, size, alignment);
             } catch (const BadAllocationException&) {
@@ -86,7 +90,7 @@ private:
     }
 
     void deallocate_impl(const MemoryBlock block) override {
-        if (primary().owns(block)) {
+        if (from_primary(block)) {
             primary().deallocate(block);
         } else {
             secondary().deallocate(block);
@@ -104,7 +108,23 @@ private:
     }
 
     bool owns_impl(const MemoryBlock block) const override {
-        return primary().owns(block) or secondary().owns(block);
+        if constexpr (has_address_range_v<Primary>) {
+            if (from_primary(block)) {
+                return primary().owns(block);
+            }
+
+            return secondary().owns(block);
+        } else {
+            return primary().owns(block) or secondary().owns(block);
+        }
+    }
+
+    bool from_primary(const MemoryBlock block) const {
+        if constexpr (has_address_range_v<Primary>) {
+            return in_address_range(primary().address_range(), block.memory);
+        } else {
+            return primary().owns(block);
+        }
     }
 
     constexpr inline Primary& primary() noexcept {
@@ -1,7 +1,11 @@
 #ifndef GREGJM_FIBONACCI_HEAP_HPP
 #define GREGJM_FIBONACCI_HEAP_HPP
 
+#include "heap_stats.hpp" // gregjm::DummyHeapStats
+
+#include <array> // std::array
 #include <cassert> // assert
+#include <algorithm> // std::max, std::min, std::push_heap, std::pop_heap
 #include <cstddef> // std::size_t, std::ptrdiff_t
 #include <memory> // std::allocator, std::allocator_traits
 #include <functional> // std::less, std::invoke
@@ -9,11 +13,15 @@
 #include <type_traits> // a lot, but mainly std::enable_if_t
 #include <initializer_list> // std::initializer_list
 #include <utility> // std::move, std::swap, std::forward
+#include <vector> // std::vector
 
 namespace gregjm {
 
+// Stats is told about comparisons, links, consolidations, cascading cuts
+// and node allocations; see HeapStats
 template <typename T, typename Compare = std::less<T>,
-          typename Allocator = std::allocator<T>>
+          typename Allocator = std::allocator<T>,
+          typename Stats = DummyHeapStats>
 class FibonacciHeap {
     static_assert(std::is_invocable_v<const Compare&, const T&, const T&>,
                   "must be able to invoke Compare with const T&");
@@ -52,6 +60,7 @@ class FibonacciHeap {
     };
 
     using OwnerT = std::unique_ptr<Node, NodeDeleter>;
+    using FrontierAllocT = typename TraitsT::template rebind_alloc<OwnerT>;
 
     // node in the heap; owns leftmost child and right sibling
     struct Node {
@@ -70,6 +79,7 @@ class FibonacciHeap {
         OwnerT right = nullptr;
         SizeT rank = 0;
         bool is_marked = false;
+        bool is_erased = false; // a tombstone left by erase_lazily
     };
 
     template <typename R, typename L>
@@ -92,6 +102,7 @@ public:
     using value_compare = Compare;
     using value_type = T;
     using allocator_type = Allocator;
+    using stats_type = Stats;
     using size_type = SizeT;
     using difference_type = std::ptrdiff_t;
     using reference = value_type&;
@@ -127,26 +138,11 @@ public:
             return pointer{ &current_->data };
         }
 
+        // skips over tombstones
         Iterator& operator++() {
-            assert(current_);
-
-            if (current_->child) { // first try descending
-                current_ = current_->child.get();
-            } else if (current_->right) { // then try the sibling
-                current_ = current_->right.get();
-            } else if (current_->parent) { // then try finding the next highest sibling
-                do {
-                    current_ = current_->parent;
-
-                    if (not current_) {
-                        return *this;
-                    }
-                } while (not current_->right);
-
-                current_ = current_->right.get();
-            } else {
-                current_ = nullptr;
-            }
+            do {
+                step();
+            } while (current_ and current_->is_erased);
 
             return *this;
         }
@@ -170,6 +166,28 @@ public:
     private:
         Iterator(const Node &current) noexcept : current_{ &current } { }
 
+        void step() noexcept {
+            assert(current_);
+
+            if (current_->child) { // first try descending
+                current_ = current_->child.get();
+            } else if (current_->right) { // then try the sibling
+                current_ = current_->right.get();
+            } else if (current_->parent) { // then try finding the next highest sibling
+                do {
+                    current_ = current_->parent;
+
+                    if (not current_) {
+                        return;
+                    }
+                } while (not current_->right);
+
+                current_ = current_->right.get();
+            } else {
+                current_ = nullptr;
+            }
+        }
+
         const Node *current_ = nullptr;
     };
     
@@ -177,7 +195,17 @@ public:
 
     // FibonacciHeap(const FibonacciHeap &other);
 
-    FibonacciHeap(FibonacciHeap &&other) = default;
+    // nodes free themselves through a pointer to their heap's allocator, so
+    // each has to be pointed at the new one. linear in other.size()
+    FibonacciHeap(FibonacciHeap &&other)
+    noexcept(std::is_nothrow_move_constructible_v<value_compare>)
+    : alloc_{ std::move(other.alloc_) }, root_{ std::move(other.root_) },
+      comparator_{ std::move(other.comparator_) }, size_{ other.size_ },
+      erased_{ other.erased_ }, stats_{ std::move(other.stats_) } {
+        other.size_ = 0;
+        other.erased_ = 0;
+        rebind_deleters();
+    }
 
     template <typename =
                   std::enable_if_t<std::is_copy_constructible_v<value_compare>>>
@@ -194,6 +222,10 @@ public:
     FibonacciHeap(const allocator_type &allocator) noexcept
     : alloc_{ allocator } { }
 
+    FibonacciHeap(const value_compare &comparator,
+                  const allocator_type &allocator)
+    : alloc_{ allocator }, comparator_{ comparator } { }
+
     FibonacciHeap(allocator_type &&allocator) noexcept
     : alloc_{ std::move(allocator) } { }
 
@@ -227,6 +259,10 @@ public:
                   const allocator_type &allocator)
     : FibonacciHeap{ init.begin(), init.end(), value_compare{ }, allocator } { }
 
+    ~FibonacciHeap() {
+        clear();
+    }
+
     // FibonacciHeap& operator=(const FibonacciHeap &other);
 
     // FibonacciHeap& operator=(FibonacciHeap &&other)
@@ -238,7 +274,19 @@ public:
         return allocator_type{ alloc_ };
     }
 
+    const stats_type& stats() const noexcept {
+        return stats_;
+    }
+
+    void reset_stats() {
+        stats_ = stats_type{ };
+    }
+
     const_iterator begin() const noexcept {
+        if (not root_) {
+            return end();
+        }
+
         return Iterator{ *root_ };
     }
 
@@ -274,44 +322,274 @@ public:
         return size_;
     }
 
-    void clear() {
-        root_ = nullptr;
+    // destroying the nodes through their owners would recurse once per
+    // sibling, so the tree is rotated into a list and freed one at a time
+    void clear() noexcept {
+        OwnerT pending = std::move(root_);
+
+        while (pending) {
+            if (pending->child) {
+                OwnerT child = std::move(pending->child);
+                pending->child = std::move(child->right);
+                child->right = std::move(pending);
+                pending = std::move(child);
+            } else {
+                // moved out first; assigning would free pending mid-move
+                OwnerT next = std::move(pending->right);
+                pending = std::move(next);
+            }
+        }
+
+        size_ = 0;
+        erased_ = 0;
     }
 
-    void push(const value_type &value) {
-        push_node(construct_node(value));
+    // the returned iterator stays valid until its element is popped and can
+    // be passed to update
+    iterator push(const value_type &value) {
+        return push_node(construct_node(value));
     }
 
-    void push(value_type &&value) {
-        push_node(construct_node(value));
+    iterator push(value_type &&value) {
+        return push_node(construct_node(std::move(value)));
     }
 
     template <typename Iterator,
               typename = std::enable_if_t<std::is_convertible_v<
                   typename std::iterator_traits<Iterator>::value_type, T
               >>>
-    void insert(Iterator first, const Iterator last) {
-        for (; first != last; ++first) {
-            push(*first);
-        }
+    void insert(const Iterator first, const Iterator last) {
+        push_batch(first, last);
     }
 
     void insert(const std::initializer_list<value_type> ilist) {
         insert(ilist.begin(), ilist.end());
     }
 
+    // every node is allocated before any is linked in, so if an allocation
+    // or comparison throws the heap is left as it was. the batch is then
+    // hung off whichever of its best element and the top wins, with one
+    // comparison per element and no melding
+    template <typename Iterator,
+              typename = std::enable_if_t<std::is_convertible_v<
+                  typename std::iterator_traits<Iterator>::value_type, T
+              >>>
+    void push_batch(Iterator first, const Iterator last) {
+        OwnerT batch;
+        Node *best = nullptr;
+        SizeT count = 0;
+
+        try {
+            for (; first != last; ++first) {
+                OwnerT node = construct_node(*first);
+
+                if (not best or lt(best->data, node->data)) {
+                    best = node.get();
+                }
+
+                if (batch) {
+                    batch->left = node.get();
+                    node->right = std::move(batch);
+                }
+
+                batch = std::move(node);
+                ++count;
+            }
+        } catch (...) {
+            free_list(std::move(batch));
+
+            throw;
+        }
+
+        if (not batch) {
+            return;
+        }
+
+        Node *parent = root_.get();
+
+        if (not root_ or lt(root_->data, best->data)) {
+            OwnerT old_root = std::move(root_);
+            root_ = unlink_sibling(best, batch);
+            parent = best;
+
+            if (old_root) {
+                adopt(*parent, std::move(old_root));
+            }
+        }
+
+        while (batch) {
+            OwnerT node = std::move(batch);
+            batch = std::move(node->right);
+            node->left = nullptr;
+            adopt(*parent, std::move(node));
+        }
+
+        size_ += count;
+    }
+
     template <typename ...Args>
-    void emplace(Args &&...args) {
-        push_node(construct_node(std::forward<Args>(args)...));
+    iterator emplace(Args &&...args) {
+        return push_node(construct_node(std::forward<Args>(args)...));
     }
 
+    // the top's children are linked pairwise by rank, as in a Fibonacci
+    // heap's consolidation, and what's left is melded into the new top
     void pop() {
-        //static_assert(false, "pop not implemented yet");
         assert(root_);
 
-        OwnerT child = std::move(root_->child);
+        OwnerT children = std::move(root_->child);
+        root_ = nullptr;
+        --size_;
+
+        root_ = consolidate(std::move(children));
+    }
+
+    // moves the k best elements to out in order, or every element if there
+    // are fewer. instead of consolidating after each one, the candidates
+    // for the next best are kept in a binary heap of subtrees and the ones
+    // left over are consolidated once at the end
+    template <typename OutputIterator>
+    OutputIterator pop_k(SizeT k, OutputIterator out) {
+        k = std::min(k, size_);
+
+        if (k == 0) {
+            return out;
+        }
+
+        const auto heap_order = [this](const OwnerT &lhs, const OwnerT &rhs) {
+            return lt(lhs->data, rhs->data);
+        };
+        std::vector<OwnerT, FrontierAllocT> frontier{
+            FrontierAllocT{ alloc_ }
+        };
+
+        try {
+            frontier.push_back(std::move(root_));
+
+            while (k != 0) {
+                // nothing below may lose a tree if it throws: the children
+                // have room before they're moved and are in the frontier
+                // before it's put back in order. it grows by doubling, so
+                // that reserving is amortized O(1) per pop
+                const std::size_t needed =
+                    frontier.size() + frontier.front()->rank;
+
+                if (frontier.capacity() < needed) {
+                    frontier.reserve(std::max(2 * frontier.capacity(),
+                                              needed));
+                }
+
+                std::pop_heap(frontier.begin(), frontier.end(), heap_order);
+
+                if (frontier.back()->is_erased) {
+                    --erased_;
+                } else {
+                    *out = std::move(frontier.back()->data);
+                    ++out;
+                    --size_;
+                    --k;
+                }
+
+                OwnerT popped = std::move(frontier.back());
+                frontier.pop_back();
+
+                const auto num_ordered =
+                    static_cast<std::ptrdiff_t>(frontier.size());
+
+                while (popped->child) {
+                    OwnerT child = std::move(popped->child);
+                    popped->child = std::move(child->right);
+                    child->parent = nullptr;
+                    child->left = nullptr;
+                    frontier.push_back(std::move(child));
+                }
+
+                for (auto end = frontier.begin() + num_ordered;
+                     end != frontier.end();) {
+                    std::push_heap(frontier.begin(), ++end, heap_order);
+                }
+            }
+        } catch (...) {
+            root_ = consolidate(link_siblings(frontier));
+
+            throw;
+        }
+
+        root_ = consolidate(link_siblings(frontier));
+
+        return out;
+    }
+
+    // assigns value to the top and moves it down to where it belongs, like
+    // a pop and a push that reuses the top's node instead of allocating.
+    // iterators to the old top now refer to the new element
+    template <typename U,
+              typename = std::enable_if_t<std::is_assignable_v<T&, U>>>
+    iterator replace_top(U &&value) {
+        assert(root_);
+
+        Node *const node = root_.get();
+        node->data = std::forward<U>(value);
+        update_priority(node);
+
+        return Iterator{ *node };
     }
 
+    // removes the element at iter. the top is popped; anything else is cut
+    // from its parent and its children are consolidated and melded into
+    // the top, so this costs about as much as a pop
+    void erase(const iterator iter) {
+        assert(iter.current_);
+        assert(not iter.current_->is_erased);
+
+        Node *const node = const_cast<Node*>(iter.current_);
+
+        if (node == root_.get()) {
+            pop();
+
+            return;
+        }
+
+        Node *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+        OwnerT detached = detach(node);
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
+
+        root_ = meld_trees(std::move(root_),
+                           consolidate(std::move(detached->child)));
+        --size_;
+    }
+
+    // removes the element at iter in constant time by leaving a tombstone
+    // in its place, for when most elements are cancelled before they reach
+    // the top. tombstones are freed when a consolidation comes across them,
+    // or all at once when they outnumber the elements left. iterators skip
+    // them, but the element isn't destroyed until its node is freed
+    void erase_lazily(const iterator iter) {
+        assert(iter.current_);
+        assert(not iter.current_->is_erased);
+
+        Node *const node = const_cast<Node*>(iter.current_);
+
+        if (node == root_.get()) {
+            pop();
+
+            return;
+        }
+
+        node->is_erased = true;
+        --size_;
+        ++erased_;
+
+        if (erased_ > size_) {
+            purge();
+        }
+    }
+
+    // linear in both sizes, as the nodes are pointed at their new allocators
     void swap(FibonacciHeap &other)
     noexcept(std::is_nothrow_swappable_v<Compare>) {
         using std::swap;
@@ -320,29 +598,332 @@ public:
         swap(root_, other.root_);
         swap(comparator_, other.comparator_);
         swap(size_, other.size_);
+        swap(erased_, other.erased_);
+        swap(stats_, other.stats_);
+
+        rebind_deleters();
+        other.rebind_deleters();
     }
 
+    // modifies the element at iter with f and moves it to wherever its new
+    // priority belongs. an element that moved toward the top is cut from
+    // its parent, which is cheap; one that moved away has its children cut
+    // instead
     template <typename Function,
               typename = std::enable_if_t<
                   std::is_invocable_v<Function, T&>
               >>
-    void update(const iterator iter, Function &&f)
-    noexcept(std::is_nothrow_invocable_v<Function, T&>) {
-        std::invoke(std::forward<Function>(f), *iter);
-        update_priority(iter);
+    void update(const iterator iter, Function &&f) {
+        assert(iter.current_);
+        assert(not iter.current_->is_erased);
+
+        Node *const node = const_cast<Node*>(iter.current_);
+
+        std::invoke(std::forward<Function>(f), node->data);
+        update_priority(node);
     }
 
 private:
-    void push_node(OwnerT node) {
+    // trees are only linked when their ranks match, so rank is logarithmic
+    // in a tree's size, except for the trees that push or update hung off
+    // the top. those go in one bucket and are melded last
+    static constexpr SizeT MAX_RANK = 64;
+
+    iterator push_node(OwnerT node) {
         assert(node);
         assert(not node->child);
         assert(not node->left);
         assert(not node->right);
         assert(node->rank == 0);
 
+        const Node &pushed = *node;
         root_ = meld_trees(std::move(node), std::move(root_));
 
         ++size_;
+
+        return Iterator{ pushed };
+    }
+
+    // takes ownership of a list of siblings and links them into one tree.
+    // a tombstone in the list is freed and its children take its place
+    OwnerT consolidate(OwnerT trees) {
+        std::array<OwnerT, MAX_RANK> by_rank;
+        OwnerT oversized;
+        SizeT highest = 0;
+        SizeT length = 0;
+
+        while (trees) {
+            ++length;
+            OwnerT tree = std::move(trees);
+            trees = std::move(tree->right);
+
+            if (trees) {
+                trees->left = nullptr;
+            }
+
+            if (tree->is_erased) {
+                if (OwnerT children = std::move(tree->child)) {
+                    Node *last = children.get();
+
+                    while (last->right) {
+                        last = last->right.get();
+                    }
+
+                    if (trees) {
+                        trees->left = last;
+                        last->right = std::move(trees);
+                    }
+
+                    trees = std::move(children);
+                }
+
+                --erased_;
+
+                continue;
+            }
+
+            tree->parent = nullptr;
+            tree->left = nullptr;
+            tree->is_marked = false;
+
+            while (tree->rank < MAX_RANK and by_rank[tree->rank]) {
+                const SizeT rank = tree->rank;
+                tree = meld_trees(std::move(by_rank[rank]), std::move(tree));
+            }
+
+            if (tree->rank >= MAX_RANK) {
+                oversized = meld_trees(std::move(oversized), std::move(tree));
+            } else {
+                highest = std::max(highest, tree->rank);
+                by_rank[tree->rank] = std::move(tree);
+            }
+        }
+
+        for (SizeT rank = 0; rank <= highest; ++rank) {
+            oversized = meld_trees(std::move(oversized),
+                                   std::move(by_rank[rank]));
+        }
+
+        stats_.count_consolidation(length);
+
+        return oversized;
+    }
+
+    // makes child, the head of a tree, the leftmost child of parent
+    static void adopt(Node &parent, OwnerT child) noexcept {
+        assert(not child->parent);
+        assert(not child->left);
+        assert(not child->right);
+
+        if (parent.child) {
+            parent.child->left = child.get();
+            child->right = std::move(parent.child);
+        }
+
+        child->parent = &parent;
+        parent.child = std::move(child);
+        ++parent.rank;
+    }
+
+    // takes node out of the parentless sibling list headed by list
+    static OwnerT unlink_sibling(Node *const node, OwnerT &list) noexcept {
+        OwnerT &owner = node->left ? node->left->right : list;
+        OwnerT unlinked = std::move(owner);
+        owner = std::move(node->right);
+
+        if (owner) {
+            owner->left = node->left;
+        }
+
+        node->left = nullptr;
+
+        return unlinked;
+    }
+
+    // chains the trees in frontier into one sibling list, emptying it
+    static OwnerT link_siblings(std::vector<OwnerT, FrontierAllocT> &frontier)
+    noexcept {
+        OwnerT list;
+
+        for (OwnerT &tree : frontier) {
+            if (not tree) {
+                continue;
+            }
+
+            if (list) {
+                list->left = tree.get();
+                tree->right = std::move(list);
+            }
+
+            list = std::move(tree);
+        }
+
+        frontier.clear();
+
+        return list;
+    }
+
+    // frees every tombstone and consolidates what's left. the heap is
+    // rotated into a list as clear does, so this doesn't recurse either
+    void purge() {
+        OwnerT pending = std::move(root_);
+        OwnerT live;
+
+        while (pending) {
+            if (pending->child) {
+                OwnerT child = std::move(pending->child);
+                pending->child = std::move(child->right);
+                child->right = std::move(pending);
+                pending = std::move(child);
+
+                continue;
+            }
+
+            OwnerT node = std::move(pending);
+            pending = std::move(node->right);
+
+            if (node->is_erased) {
+                continue;
+            }
+
+            node->parent = nullptr;
+            node->left = nullptr;
+            node->rank = 0;
+            node->is_marked = false;
+
+            if (live) {
+                live->left = node.get();
+                node->right = std::move(live);
+            }
+
+            live = std::move(node);
+        }
+
+        erased_ = 0;
+        root_ = consolidate(std::move(live));
+    }
+
+    // a detached tree headed by a tombstone is replaced by its children
+    OwnerT reclaim(OwnerT tree) {
+        if (tree->is_erased) {
+            return consolidate(std::move(tree));
+        }
+
+        return tree;
+    }
+
+    // frees a list of childless siblings without recursing down it
+    static void free_list(OwnerT list) noexcept {
+        while (list) {
+            OwnerT next = std::move(list->right);
+            list = std::move(next);
+        }
+    }
+
+    // unlinks node from its parent and siblings and returns its subtree
+    // assumes node isn't the top
+    OwnerT detach(Node *const node) noexcept {
+        assert(node->parent);
+
+        OwnerT &owner = node->left ? node->left->right : node->parent->child;
+        OwnerT detached = std::move(owner);
+        owner = std::move(node->right);
+
+        if (owner) {
+            owner->left = node->left;
+        }
+
+        --node->parent->rank;
+        node->parent = nullptr;
+        node->left = nullptr;
+        node->is_marked = false;
+
+        return detached;
+    }
+
+    // the top's children play the part of the root list, so they're never
+    // marked or cut
+    bool is_root(const Node *const node) const noexcept {
+        return node == root_.get() or node->parent == root_.get();
+    }
+
+    void update_priority(Node *const node) {
+        if (node->parent and lt(node->parent->data, node->data)) {
+            promote(node);
+
+            return;
+        }
+
+        for (const Node *child = node->child.get(); child;
+             child = child->right.get()) {
+            if (lt(node->data, child->data)) {
+                demote(node);
+
+                return;
+            }
+        }
+    }
+
+    // node now outranks its parent
+    void promote(Node *const node) {
+        Node *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+
+        root_ = meld_trees(std::move(root_), detach(node));
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
+    }
+
+    // a node that's lost a child is marked; one that loses a second is cut
+    // from its own parent in turn
+    void cascading_cut(Node *node) {
+        while (not is_root(node)) {
+            if (not node->is_marked) {
+                node->is_marked = true;
+
+                return;
+            }
+
+            Node *const parent = node->parent;
+            stats_.count_cascading_cut();
+            root_ = meld_trees(std::move(root_), reclaim(detach(node)));
+            node = parent;
+        }
+    }
+
+    // some children of node now outrank it
+    void demote(Node *const node) {
+        if (node == root_.get()) {
+            OwnerT top = std::move(root_);
+            OwnerT children = std::move(top->child);
+            top->rank = 0;
+
+            if (children) {
+                children->left = top.get();
+                top->right = std::move(children);
+            }
+
+            root_ = consolidate(std::move(top));
+
+            return;
+        }
+
+        Node *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+        OwnerT detached = detach(node);
+
+        while (detached->child) {
+            root_ = meld_trees(std::move(root_),
+                               reclaim(detach(detached->child.get())));
+        }
+
+        root_ = meld_trees(std::move(root_), std::move(detached));
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
     }
 
     // returns the new root of the melded tree
@@ -364,6 +945,8 @@ private:
         assert(not second->left);
         assert(not second->right);
 
+        stats_.count_link();
+
         if (lt(first->data, second->data)) {
             if (second->child) {
                 second->child->left = first.get();
@@ -390,14 +973,36 @@ private:
         return first;
     }
 
-    void update_priority(Node *const node) noexcept {
-        //static_assert(false, "update_priority not implemented");
-    }
-
     inline NodeDeleter make_deleter() noexcept {
         return NodeDeleter{ alloc_ };
     }
 
+    // points every owner in the heap at alloc_, walking the trees in
+    // preorder without a stack
+    void rebind_deleters() noexcept {
+        root_.get_deleter() = make_deleter();
+        Node *node = root_.get();
+
+        while (node) {
+            node->child.get_deleter() = make_deleter();
+            node->right.get_deleter() = make_deleter();
+
+            if (node->child) {
+                node = node->child.get();
+
+                continue;
+            }
+
+            while (node and not node->right) {
+                node = node->parent;
+            }
+
+            if (node) {
+                node = node->right.get();
+            }
+        }
+    }
+
     template <typename ...Args,
               typename = std::enable_if_t<
                   std::is_constructible_v<Node, Args...>
@@ -405,71 +1010,77 @@ private:
     OwnerT construct_node(Args &&...args) {
         Node *node = RebindTraitsT::allocate(alloc_, 1);
         RebindTraitsT::construct(alloc_, node, std::forward<Args>(args)...);
+        stats_.count_allocation();
 
         return OwnerT{ node, make_deleter() };
     }
 
+    // every call to the comparator goes through here to be counted
+    template <typename L, typename R,
+              typename = std::enable_if_t<IsComparable<L, R>::value>>
+    inline bool compare(L &&lhs, R &&rhs) const
+    noexcept(IsNothrowComparable<L, R>::value) {
+        stats_.count_comparison();
+
+        return std::invoke(comparator_, std::forward<L>(lhs),
+                           std::forward<R>(rhs));
+    }
+
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool eq(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return not std::invoke(comparator_, std::forward<L>(lhs),
-                               std::forward<R>(rhs))
-               and not std::invoke(comparator_, std::forward<R>(rhs),
-                                   std::forward<L>(lhs));
+        return not compare(std::forward<L>(lhs), std::forward<R>(rhs))
+               and not compare(std::forward<R>(rhs), std::forward<L>(lhs));
     }
 
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool ne(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return std::invoke(comparator_, std::forward<L>(lhs),
-                           std::forward<R>(rhs))
-               or std::invoke(comparator_, std::forward<R>(rhs),
-                              std::forward<L>(lhs));
+        return compare(std::forward<L>(lhs), std::forward<R>(rhs))
+               or compare(std::forward<R>(rhs), std::forward<L>(lhs));
     }
 
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool lt(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return std::invoke(comparator_, std::forward<L>(lhs),
-                           std::forward<R>(rhs));
+        return compare(std::forward<L>(lhs), std::forward<R>(rhs));
     }
 
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool le(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return not std::invoke(comparator_, std::forward<R>(rhs),
-                               std::forward<L>(lhs));
+        return not compare(std::forward<R>(rhs), std::forward<L>(lhs));
     }
 
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool gt(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return std::invoke(comparator_, std::forward<R>(rhs),
-                           std::forward<L>(lhs));
+        return compare(std::forward<R>(rhs), std::forward<L>(lhs));
     }
 
     template <typename L, typename R,
               typename = std::enable_if_t<IsComparable<L, R>::value>>
     inline bool ge(L &&lhs, R &&rhs) const
     noexcept(IsNothrowComparable<L, R>::value) {
-        return not std::invoke(comparator_, std::forward<L>(lhs),
-                               std::forward<R>(rhs));
+        return not compare(std::forward<L>(lhs), std::forward<R>(rhs));
     }
 
     RebindAllocT alloc_{ };
     OwnerT root_;
     value_compare comparator_{ };
     size_t size_ = 0;
+    size_t erased_ = 0; // tombstones still linked in
+    mutable stats_type stats_{ };
 };
 
-template <typename T, typename Compare, typename Allocator>
-void swap(FibonacciHeap<T, Compare, Allocator> &lhs,
-          FibonacciHeap<T, Compare, Allocator> &rhs)
+template <typename T, typename Compare, typename Allocator, typename Stats>
+void swap(FibonacciHeap<T, Compare, Allocator, Stats> &lhs,
+          FibonacciHeap<T, Compare, Allocator, Stats> &rhs)
 noexcept(noexcept(lhs.swap(rhs))) {
     lhs.swap(rhs);
 }
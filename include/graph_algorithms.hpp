@@ -0,0 +1,319 @@
+#ifndef GREGJM_GRAPH_ALGORITHMS_HPP
+#define GREGJM_GRAPH_ALGORITHMS_HPP
+
+#include "csr_graph.hpp" // gregjm::CsrGraph, gregjm::VertexId
+#include "fibonacci_heap.hpp" // gregjm::FibonacciHeap
+#include "radix_heap.hpp" // gregjm::RadixHeap
+
+#include <algorithm> // std::push_heap, std::pop_heap
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <limits> // std::numeric_limits
+#include <memory> // std::allocator
+#include <utility> // std::pair
+#include <vector> // std::vector
+
+namespace gregjm {
+
+// the searches below are written against a heap engine: a priority queue
+// of vertices keyed by tentative distance that supports decrease_key. an
+// engine has
+//
+//     void reset(std::size_t num_vertices);
+//     bool empty();
+//     void push(VertexId vertex, Key key);
+//     void decrease_key(VertexId vertex, Key key);
+//     KeyedVertex<Key> pop();
+//
+// a vertex is pushed at most once per search, decrease_key is only called
+// on queued vertices with a strictly smaller key, and pop returns the queued
+// vertex with the smallest key
+
+template <typename Key>
+struct KeyedVertex {
+    Key key;
+    VertexId vertex;
+};
+
+namespace detail {
+
+template <typename Key>
+struct KeyGreater {
+    bool operator()(const KeyedVertex<Key> &lhs,
+                    const KeyedVertex<Key> &rhs) const noexcept {
+        return lhs.key > rhs.key;
+    }
+};
+
+} // namespace detail
+
+inline constexpr VertexId NO_VERTEX = std::numeric_limits<VertexId>::max();
+
+template <typename Weight>
+constexpr Weight unreachable() noexcept {
+    return std::numeric_limits<Weight>::max();
+}
+
+// a FibonacciHeap with a handle per vertex, so decrease_key is a cut
+template <typename Key,
+          typename Allocator = std::allocator<KeyedVertex<Key>>>
+class FibonacciEngine {
+    using HeapT = FibonacciHeap<KeyedVertex<Key>, detail::KeyGreater<Key>,
+                                Allocator>;
+
+public:
+    FibonacciEngine() = default;
+
+    explicit FibonacciEngine(const Allocator &alloc) : heap_{ alloc } { }
+
+    void reset(const std::size_t num_vertices) {
+        heap_.clear();
+        handles_.resize(num_vertices);
+    }
+
+    bool empty() const noexcept {
+        return heap_.empty();
+    }
+
+    void push(const VertexId vertex, const Key key) {
+        handles_[vertex] = heap_.push(KeyedVertex<Key>{ key, vertex });
+    }
+
+    void decrease_key(const VertexId vertex, const Key key) {
+        heap_.update(handles_[vertex], [key](KeyedVertex<Key> &entry) {
+            assert(key < entry.key);
+
+            entry.key = key;
+        });
+    }
+
+    KeyedVertex<Key> pop() {
+        const KeyedVertex<Key> top = heap_.top();
+        heap_.pop();
+
+        return top;
+    }
+
+private:
+    HeapT heap_;
+    std::vector<typename HeapT::iterator> handles_;
+};
+
+// a binary heap in a vector without decrease_key: a smaller key is pushed
+// as a new entry and the stale ones are skipped when they surface
+template <typename Key,
+          typename Allocator = std::allocator<KeyedVertex<Key>>>
+class BinaryHeapEngine {
+public:
+    BinaryHeapEngine() = default;
+
+    explicit BinaryHeapEngine(const Allocator &alloc) : heap_{ alloc } { }
+
+    void reset(const std::size_t num_vertices) {
+        heap_.clear();
+        keys_.resize(num_vertices);
+    }
+
+    bool empty() {
+        while (not heap_.empty() and is_stale(heap_.front())) {
+            pop_front();
+        }
+
+        return heap_.empty();
+    }
+
+    void push(const VertexId vertex, const Key key) {
+        keys_[vertex] = key;
+        heap_.push_back(KeyedVertex<Key>{ key, vertex });
+        std::push_heap(heap_.begin(), heap_.end(), detail::KeyGreater<Key>{ });
+    }
+
+    void decrease_key(const VertexId vertex, const Key key) {
+        assert(key < keys_[vertex]);
+
+        push(vertex, key);
+    }
+
+    KeyedVertex<Key> pop() {
+        while (is_stale(heap_.front())) {
+            pop_front();
+        }
+
+        const KeyedVertex<Key> top = heap_.front();
+        pop_front();
+
+        return top;
+    }
+
+private:
+    bool is_stale(const KeyedVertex<Key> &entry) const noexcept {
+        return entry.key != keys_[entry.vertex];
+    }
+
+    void pop_front() {
+        std::pop_heap(heap_.begin(), heap_.end(), detail::KeyGreater<Key>{ });
+        heap_.pop_back();
+    }
+
+    std::vector<KeyedVertex<Key>, Allocator> heap_;
+    std::vector<Key> keys_;
+};
+
+// a RadixHeap that handles decrease_key like BinaryHeapEngine. dijkstra
+// pops distances in increasing order and never pushes one below the last
+// it popped, so its keys are monotone; prim's aren't, so it can't use this
+template <typename Key,
+          typename Allocator = std::allocator<std::pair<Key, VertexId>>>
+class RadixHeapEngine {
+public:
+    RadixHeapEngine() = default;
+
+    explicit RadixHeapEngine(const Allocator &alloc) : heap_{ alloc } { }
+
+    void reset(const std::size_t num_vertices) {
+        heap_.clear();
+        keys_.resize(num_vertices);
+    }
+
+    bool empty() {
+        while (not heap_.empty() and is_stale(heap_.top())) {
+            heap_.pop();
+        }
+
+        return heap_.empty();
+    }
+
+    void push(const VertexId vertex, const Key key) {
+        keys_[vertex] = key;
+        heap_.emplace(key, vertex);
+    }
+
+    void decrease_key(const VertexId vertex, const Key key) {
+        assert(key < keys_[vertex]);
+
+        push(vertex, key);
+    }
+
+    KeyedVertex<Key> pop() {
+        while (is_stale(heap_.top())) {
+            heap_.pop();
+        }
+
+        const auto [key, vertex] = heap_.top();
+        heap_.pop();
+
+        return KeyedVertex<Key>{ key, vertex };
+    }
+
+private:
+    bool is_stale(const std::pair<Key, VertexId> &entry) const noexcept {
+        return entry.first != keys_[entry.second];
+    }
+
+    RadixHeap<Key, VertexId, Allocator> heap_;
+    std::vector<Key> keys_;
+};
+
+// single-source shortest path distances over nonnegative weights, or
+// unreachable<Weight>() for vertices that can't be reached from source
+template <typename Weight, typename Engine>
+std::vector<Weight> dijkstra(const CsrGraph<Weight> &graph,
+                             const VertexId source, Engine &engine) {
+    std::vector<Weight> distances(graph.num_vertices(),
+                                  unreachable<Weight>());
+
+    engine.reset(graph.num_vertices());
+    distances[source] = Weight{ 0 };
+    engine.push(source, Weight{ 0 });
+
+    while (not engine.empty()) {
+        const KeyedVertex<Weight> top = engine.pop();
+
+        for (const auto &arc : graph.arcs(top.vertex)) {
+            const Weight distance = top.key + arc.weight;
+            Weight &best = distances[arc.target];
+
+            if (distance >= best) {
+                continue;
+            }
+
+            if (best == unreachable<Weight>()) {
+                engine.push(arc.target, distance);
+            } else {
+                engine.decrease_key(arc.target, distance);
+            }
+
+            best = distance;
+        }
+    }
+
+    return distances;
+}
+
+template <typename Weight>
+std::vector<Weight> dijkstra(const CsrGraph<Weight> &graph,
+                             const VertexId source) {
+    FibonacciEngine<Weight> engine;
+
+    return dijkstra(graph, source, engine);
+}
+
+template <typename Weight>
+struct SpanningTree {
+    // NO_VERTEX for the root and for vertices it doesn't reach
+    std::vector<VertexId> parents;
+    Weight weight = Weight{ 0 };
+};
+
+// a minimum spanning tree of root's component, which expects every edge to
+// be stored in both directions, as in an undirected CsrGraph
+template <typename Weight, typename Engine>
+SpanningTree<Weight> prim(const CsrGraph<Weight> &graph, const VertexId root,
+                          Engine &engine) {
+    const VertexId num_vertices = graph.num_vertices();
+    SpanningTree<Weight> tree{ std::vector<VertexId>(num_vertices, NO_VERTEX),
+                               Weight{ 0 } };
+    std::vector<Weight> keys(num_vertices, unreachable<Weight>());
+    std::vector<bool> in_tree(num_vertices, false);
+
+    engine.reset(num_vertices);
+    keys[root] = Weight{ 0 };
+    engine.push(root, Weight{ 0 });
+
+    while (not engine.empty()) {
+        const KeyedVertex<Weight> top = engine.pop();
+        in_tree[top.vertex] = true;
+        tree.weight += top.key;
+
+        for (const auto &arc : graph.arcs(top.vertex)) {
+            Weight &key = keys[arc.target];
+
+            if (in_tree[arc.target] or arc.weight >= key) {
+                continue;
+            }
+
+            if (key == unreachable<Weight>()) {
+                engine.push(arc.target, arc.weight);
+            } else {
+                engine.decrease_key(arc.target, arc.weight);
+            }
+
+            key = arc.weight;
+            tree.parents[arc.target] = top.vertex;
+        }
+    }
+
+    return tree;
+}
+
+template <typename Weight>
+SpanningTree<Weight> prim(const CsrGraph<Weight> &graph,
+                          const VertexId root) {
+    FibonacciEngine<Weight> engine;
+
+    return prim(graph, root, engine);
+}
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef GREGJM_HEAP_STATS_HPP
+#define GREGJM_HEAP_STATS_HPP
+
+#include <algorithm> // std::max
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+
+namespace gregjm {
+
+// the Stats policy the heaps use by default; every hook does nothing, so
+// uninstrumented heaps compile to what they would without it
+struct DummyHeapStats {
+    constexpr inline void count_comparison() noexcept { }
+
+    constexpr inline void count_link() noexcept { }
+
+    constexpr inline void count_consolidation(const std::size_t) noexcept { }
+
+    constexpr inline void count_cascading_cut() noexcept { }
+
+    constexpr inline void count_allocation() noexcept { }
+};
+
+// counts what a heap spends its time on, to see why a workload is slow
+// without a profiler. pass it as a heap's Stats policy and read it back
+// through the heap's stats()
+struct HeapStats {
+    void count_comparison() noexcept {
+        ++comparisons;
+    }
+
+    void count_link() noexcept {
+        ++links;
+    }
+
+    // a consolidation of a root list with length trees in it
+    void count_consolidation(const std::size_t length) noexcept {
+        ++consolidations;
+        max_root_list = std::max(max_root_list,
+                                 static_cast<std::uint64_t>(length));
+    }
+
+    void count_cascading_cut() noexcept {
+        ++cascading_cuts;
+    }
+
+    void count_allocation() noexcept {
+        ++allocations;
+    }
+
+    // calls to the heap's comparator
+    std::uint64_t comparisons = 0;
+
+    // trees hung under another tree's root while melding
+    std::uint64_t links = 0;
+
+    std::uint64_t consolidations = 0;
+
+    // the longest list of trees a consolidation has been given
+    std::uint64_t max_root_list = 0;
+
+    // ancestors cut for having lost a second child
+    std::uint64_t cascading_cuts = 0;
+
+    std::uint64_t allocations = 0;
+};
+
+} // namespace gregjm
+
+#endif
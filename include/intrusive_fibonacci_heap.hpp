@@ -0,0 +1,434 @@
+#ifndef GREGJM_INTRUSIVE_FIBONACCI_HEAP_HPP
+#define GREGJM_INTRUSIVE_FIBONACCI_HEAP_HPP
+
+#include "heap_stats.hpp" // gregjm::DummyHeapStats
+
+#include <algorithm> // std::max
+#include <array> // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <functional> // std::less, std::invoke
+#include <type_traits> // std::is_base_of_v, std::is_invocable_v,
+                       // std::enable_if_t
+#include <utility> // std::exchange, std::forward, std::move, std::swap
+
+namespace gregjm {
+
+// the links an object needs to be in an IntrusiveFibonacciHeap, usually
+// inherited. an object can be in one heap per Tag at a time, and has to be
+// popped or erased before it's destroyed. copying an object doesn't copy
+// its place in a heap
+template <typename Tag = void>
+struct FibonacciHeapHook {
+    FibonacciHeapHook() noexcept = default;
+
+    FibonacciHeapHook(const FibonacciHeapHook&) noexcept { }
+
+    FibonacciHeapHook& operator=(const FibonacciHeapHook&) noexcept {
+        return *this;
+    }
+
+    bool is_linked() const noexcept {
+        return linked;
+    }
+
+    FibonacciHeapHook *parent = nullptr;
+    FibonacciHeapHook *child = nullptr; // always the leftmost child
+    FibonacciHeapHook *left = nullptr;
+    FibonacciHeapHook *right = nullptr;
+    std::size_t rank = 0;
+    bool is_marked = false;
+    bool linked = false;
+};
+
+// a FibonacciHeap over objects that carry their own links, so pushing,
+// reprioritizing and erasing never allocate and objects can live anywhere,
+// such as an arena. the heap never owns what's in it; T has to derive from
+// FibonacciHeapHook<Tag>. Stats is told what the heap does, as with
+// FibonacciHeap, though it never allocates
+template <typename T, typename Compare = std::less<T>, typename Tag = void,
+          typename Stats = DummyHeapStats>
+class IntrusiveFibonacciHeap {
+    using HookT = FibonacciHeapHook<Tag>;
+
+    static_assert(std::is_base_of_v<HookT, T>,
+                  "T must derive from FibonacciHeapHook<Tag>");
+    static_assert(std::is_invocable_v<const Compare&, const T&, const T&>,
+                  "must be able to invoke Compare with const T&");
+
+    static inline constexpr bool IS_NOTHROW_COMPARABLE =
+        std::is_nothrow_invocable_v<const Compare&, const T&, const T&>;
+
+public:
+    using value_compare = Compare;
+    using value_type = T;
+    using stats_type = Stats;
+    using size_type = std::size_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    IntrusiveFibonacciHeap() = default;
+
+    explicit IntrusiveFibonacciHeap(const value_compare &comparator)
+    : comparator_{ comparator } { }
+
+    IntrusiveFibonacciHeap(IntrusiveFibonacciHeap &&other) noexcept
+    : root_{ std::exchange(other.root_, nullptr) },
+      comparator_{ std::move(other.comparator_) },
+      size_{ std::exchange(other.size_, 0) },
+      stats_{ std::move(other.stats_) } { }
+
+    IntrusiveFibonacciHeap(const IntrusiveFibonacciHeap &other) = delete;
+
+    IntrusiveFibonacciHeap&
+    operator=(const IntrusiveFibonacciHeap &other) = delete;
+
+    // unlinks everything left, so the objects can go in another heap
+    ~IntrusiveFibonacciHeap() {
+        clear();
+    }
+
+    reference top() {
+        assert(root_);
+
+        return as_value(root_);
+    }
+
+    const_reference top() const {
+        assert(root_);
+
+        return as_value(root_);
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    const stats_type& stats() const noexcept {
+        return stats_;
+    }
+
+    void reset_stats() {
+        stats_ = stats_type{ };
+    }
+
+    // unlinks every element without recursing
+    void clear() noexcept {
+        HookT *pending = std::exchange(root_, nullptr);
+
+        while (pending) {
+            if (pending->child) {
+                HookT *const child = pending->child;
+                pending->child = child->right;
+                child->right = pending;
+                pending = child;
+            } else {
+                HookT *const next = pending->right;
+                reset(*pending);
+                pending = next;
+            }
+        }
+
+        size_ = 0;
+    }
+
+    void push(reference element) noexcept(IS_NOTHROW_COMPARABLE) {
+        HookT &node = element;
+
+        assert(not node.linked);
+
+        node.linked = true;
+        root_ = meld_trees(root_, &node);
+        ++size_;
+    }
+
+    // unlinks the top; the object itself is left alone
+    void pop() noexcept(IS_NOTHROW_COMPARABLE) {
+        assert(root_);
+
+        HookT *const top = std::exchange(root_, nullptr);
+        HookT *const children = std::exchange(top->child, nullptr);
+        reset(*top);
+        --size_;
+
+        root_ = consolidate(children);
+    }
+
+    // unlinks element from wherever it is in the heap
+    void erase(reference element) noexcept(IS_NOTHROW_COMPARABLE) {
+        HookT *const node = &static_cast<HookT&>(element);
+
+        assert(node->linked);
+
+        if (node == root_) {
+            pop();
+
+            return;
+        }
+
+        HookT *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+        detach(node);
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
+
+        root_ = meld_trees(root_,
+                           consolidate(std::exchange(node->child, nullptr)));
+        reset(*node);
+        --size_;
+    }
+
+    // modifies element with f, then moves it to where its new priority
+    // belongs
+    template <typename Function,
+              typename = std::enable_if_t<
+                  std::is_invocable_v<Function, reference>
+              >>
+    void update(reference element, Function &&f) {
+        std::invoke(std::forward<Function>(f), element);
+        update(element);
+    }
+
+    // moves element to where its priority belongs after it was changed in
+    // place
+    void update(reference element) noexcept(IS_NOTHROW_COMPARABLE) {
+        HookT *const node = &static_cast<HookT&>(element);
+
+        assert(node->linked);
+
+        if (node->parent and lt(node->parent, node)) {
+            promote(node);
+
+            return;
+        }
+
+        for (const HookT *child = node->child; child; child = child->right) {
+            if (lt(node, child)) {
+                demote(node);
+
+                return;
+            }
+        }
+    }
+
+    void swap(IntrusiveFibonacciHeap &other)
+    noexcept(std::is_nothrow_swappable_v<Compare>) {
+        using std::swap;
+
+        swap(root_, other.root_);
+        swap(comparator_, other.comparator_);
+        swap(size_, other.size_);
+        swap(stats_, other.stats_);
+    }
+
+private:
+    // the same bound as FibonacciHeap's; see there
+    static constexpr size_type MAX_RANK = 64;
+
+    static reference as_value(HookT *const node) noexcept {
+        return static_cast<reference>(*node);
+    }
+
+    static void reset(HookT &node) noexcept {
+        node.parent = nullptr;
+        node.child = nullptr;
+        node.left = nullptr;
+        node.right = nullptr;
+        node.rank = 0;
+        node.is_marked = false;
+        node.linked = false;
+    }
+
+    // takes a list of siblings and links them into one tree
+    HookT* consolidate(HookT *trees) noexcept(IS_NOTHROW_COMPARABLE) {
+        std::array<HookT*, MAX_RANK> by_rank{ };
+        HookT *oversized = nullptr;
+        size_type highest = 0;
+        size_type length = 0;
+
+        while (trees) {
+            ++length;
+            HookT *tree = trees;
+            trees = tree->right;
+
+            if (trees) {
+                trees->left = nullptr;
+            }
+
+            tree->parent = nullptr;
+            tree->left = nullptr;
+            tree->right = nullptr;
+            tree->is_marked = false;
+
+            while (tree->rank < MAX_RANK and by_rank[tree->rank]) {
+                const size_type rank = tree->rank;
+                tree = meld_trees(std::exchange(by_rank[rank], nullptr),
+                                  tree);
+            }
+
+            if (tree->rank >= MAX_RANK) {
+                oversized = meld_trees(oversized, tree);
+            } else {
+                highest = std::max(highest, tree->rank);
+                by_rank[tree->rank] = tree;
+            }
+        }
+
+        for (size_type rank = 0; rank <= highest; ++rank) {
+            oversized = meld_trees(oversized, by_rank[rank]);
+        }
+
+        stats_.count_consolidation(length);
+
+        return oversized;
+    }
+
+    // unlinks node from its parent and siblings; assumes it isn't the top
+    static void detach(HookT *const node) noexcept {
+        assert(node->parent);
+
+        if (node->left) {
+            node->left->right = node->right;
+        } else {
+            node->parent->child = node->right;
+        }
+
+        if (node->right) {
+            node->right->left = node->left;
+        }
+
+        --node->parent->rank;
+        node->parent = nullptr;
+        node->left = nullptr;
+        node->right = nullptr;
+        node->is_marked = false;
+    }
+
+    // the top's children play the part of the root list
+    bool is_root(const HookT *const node) const noexcept {
+        return node == root_ or node->parent == root_;
+    }
+
+    // node now outranks its parent
+    void promote(HookT *const node) noexcept(IS_NOTHROW_COMPARABLE) {
+        HookT *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+
+        detach(node);
+        root_ = meld_trees(root_, node);
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
+    }
+
+    void cascading_cut(HookT *node) noexcept(IS_NOTHROW_COMPARABLE) {
+        while (not is_root(node)) {
+            if (not node->is_marked) {
+                node->is_marked = true;
+
+                return;
+            }
+
+            HookT *const parent = node->parent;
+            stats_.count_cascading_cut();
+            detach(node);
+            root_ = meld_trees(root_, node);
+            node = parent;
+        }
+    }
+
+    // some children of node now outrank it
+    void demote(HookT *const node) noexcept(IS_NOTHROW_COMPARABLE) {
+        if (node == root_) {
+            HookT *const top = std::exchange(root_, nullptr);
+            HookT *const children = std::exchange(top->child, nullptr);
+            top->rank = 0;
+
+            if (children) {
+                children->left = top;
+                top->right = children;
+            }
+
+            root_ = consolidate(top);
+
+            return;
+        }
+
+        HookT *const parent = node->parent;
+        const bool cascade = not is_root(parent);
+        detach(node);
+
+        while (node->child) {
+            HookT *const child = node->child;
+            detach(child);
+            root_ = meld_trees(root_, child);
+        }
+
+        root_ = meld_trees(root_, node);
+
+        if (cascade) {
+            cascading_cut(parent);
+        }
+    }
+
+    // returns the root of the melded tree; ties keep first on top
+    HookT* meld_trees(HookT *const first, HookT *const second) const
+    noexcept(IS_NOTHROW_COMPARABLE) {
+        if (not first) {
+            return second;
+        } else if (not second) {
+            return first;
+        }
+
+        assert(not first->parent and not first->left and not first->right);
+        assert(not second->parent and not second->left
+               and not second->right);
+
+        stats_.count_link();
+
+        HookT *const winner = lt(first, second) ? second : first;
+        HookT *const loser = (winner == first) ? second : first;
+
+        if (winner->child) {
+            winner->child->left = loser;
+            loser->right = winner->child;
+        }
+
+        loser->parent = winner;
+        winner->child = loser;
+        ++winner->rank;
+
+        return winner;
+    }
+
+    bool lt(const HookT *const lhs, const HookT *const rhs) const
+    noexcept(IS_NOTHROW_COMPARABLE) {
+        stats_.count_comparison();
+
+        return std::invoke(comparator_, static_cast<const T&>(*lhs),
+                           static_cast<const T&>(*rhs));
+    }
+
+    HookT *root_ = nullptr;
+    value_compare comparator_{ };
+    size_type size_ = 0;
+    mutable stats_type stats_{ };
+};
+
+template <typename T, typename Compare, typename Tag, typename Stats>
+void swap(IntrusiveFibonacciHeap<T, Compare, Tag, Stats> &lhs,
+          IntrusiveFibonacciHeap<T, Compare, Tag, Stats> &rhs)
+noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+} // namespace gregjm
+
+#endif
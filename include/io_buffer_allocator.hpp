@@ -0,0 +1,247 @@
+#ifndef GREGJM_IO_BUFFER_ALLOCATOR_HPP
+#define GREGJM_IO_BUFFER_ALLOCATOR_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::NotOwnedException,
+                                     // gregjm::BadAllocationException
+#include "address_range.hpp" // gregjm::in_address_range
+#include "virtual_memory.hpp" // gregjm::map_memory, gregjm::release_memory,
+                              // gregjm::round_to_pages, gregjm::page_size
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <array> // std::array
+#include <bitset> // std::bitset
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uint32_t
+#include <mutex> // std::scoped_lock
+#include <new> // std::bad_alloc
+#include <vector> // std::vector
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h> // IORING_REGISTER_BUFFERS,
+                            // IORING_UNREGISTER_BUFFERS
+#include <sys/syscall.h> // __NR_io_uring_register
+#include <sys/uio.h> // iovec
+#include <unistd.h> // syscall
+#endif
+#endif
+
+namespace gregjm {
+
+// an I/O buffer along with its index in the registered buffer table, to be
+// passed as buf_index in IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED
+struct IoBuffer {
+    MemoryBlock block;
+    std::uint32_t index;
+};
+
+// hands out BufferCount buffers of up to BufferSize bytes, each starting on
+// a page boundary, from a single region. given an io_uring file descriptor,
+// the region is registered with IORING_REGISTER_BUFFERS so fixed-buffer
+// reads and writes needn't pin and map pages for every operation. if
+// io_uring isn't available or registration fails (old kernel, seccomp,
+// RLIMIT_MEMLOCK, more than 16384 buffers) the buffers are just page-aligned
+// memory and is_registered() is false
+//
+// buffers are recycled by deallocating them once their completion arrives
+template <std::size_t BufferSize, std::size_t BufferCount,
+          typename Mutex = DummyMutex>
+class IoBufferAllocator final : public PolymorphicAllocator {
+    static_assert(BufferSize > 0, "BufferSize must be positive");
+    static_assert(BufferCount > 0 and BufferCount <= UINT32_MAX,
+                  "BufferCount must fit in a buffer index");
+
+    using LockT = std::scoped_lock<Mutex>;
+
+public:
+    IoBufferAllocator() : IoBufferAllocator{ -1 } { }
+
+    explicit IoBufferAllocator(const int ring_fd)
+    : stride_{ round_to_pages(BufferSize) },
+      region_{
+          static_cast<std::uint8_t*>(map_memory(stride_ * BufferCount))
+      } {
+        deallocate_all_impl();
+        register_buffers(ring_fd);
+    }
+
+    IoBufferAllocator(const IoBufferAllocator &other) = delete;
+
+    IoBufferAllocator& operator=(const IoBufferAllocator &other) = delete;
+
+    virtual ~IoBufferAllocator() {
+        unregister_buffers();
+        release_memory(region_, stride_ * BufferCount);
+    }
+
+    // throws BadAllocationException if size > BufferSize or every buffer is
+    // in use
+    IoBuffer allocate_buffer(const std::size_t size) {
+        if (size > BufferSize) {
+            throw BadAllocationException{ };
+        }
+
+        const LockT lock{ mutex_ };
+
+        if (num_free_ == 0) {
+            throw BadAllocationException{ };
+        }
+
+        const std::uint32_t index = free_[--num_free_];
+        in_use_[index] = true;
+
+        return IoBuffer{ MemoryBlock{ region_ + index * stride_, size },
+                         index };
+    }
+
+    // the registered buffer index of a block from this allocator
+    std::uint32_t buffer_index(const MemoryBlock block) const {
+        if (not in_address_range(address_range(), block.memory)) {
+            throw NotOwnedException{ };
+        }
+
+        const auto offset =
+            static_cast<std::size_t>(static_cast<std::uint8_t*>(block.memory)
+                                     - region_);
+
+        return static_cast<std::uint32_t>(offset / stride_);
+    }
+
+    // the whole buffer with the given index
+    MemoryBlock buffer(const std::uint32_t index) const noexcept {
+        return MemoryBlock{ region_ + index * stride_, BufferSize };
+    }
+
+    bool is_registered() const noexcept {
+        return ring_fd_ >= 0;
+    }
+
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ region_, stride_ * BufferCount };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        if (alignment > page_size()) {
+            throw BadAllocationException{ };
+        }
+
+        return allocate_buffer(size).block;
+    }
+
+    // buffers never move; they can only grow up to BufferSize
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        if (size > BufferSize or alignment > page_size()) {
+            throw BadAllocationException{ };
+        }
+
+        const std::uint32_t index = buffer_index(block);
+
+        {
+            const LockT lock{ mutex_ };
+
+            if (not in_use_[index]) {
+                throw NotOwnedException{ };
+            }
+        }
+
+        return MemoryBlock{ buffer(index).memory, size };
+    }
+
+    // throws NotOwnedException if the buffer isn't in use, so that a double
+    // free can't hand a buffer out twice or overrun free_
+    void deallocate_impl(const MemoryBlock block) override {
+        const std::uint32_t index = buffer_index(block);
+
+        const LockT lock{ mutex_ };
+
+        if (not in_use_[index]) {
+            throw NotOwnedException{ };
+        }
+
+        in_use_[index] = false;
+        free_[num_free_++] = index;
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        // hand out low indices first
+        for (std::size_t i = 0; i < BufferCount; ++i) {
+            free_[i] = static_cast<std::uint32_t>(BufferCount - 1 - i);
+        }
+
+        num_free_ = BufferCount;
+        in_use_.reset();
+    }
+
+    std::size_t max_size_impl() const override {
+        return BufferSize;
+    }
+
+    // free buffers aren't owned, to agree with deallocate
+    bool owns_impl(const MemoryBlock block) const override {
+        if (not in_address_range(address_range(), block.memory)) {
+            return false;
+        }
+
+        const std::uint32_t index = buffer_index(block);
+
+        const LockT lock{ mutex_ };
+
+        return in_use_[index];
+    }
+
+#if defined(__NR_io_uring_register)
+    void register_buffers(const int ring_fd) noexcept {
+        if (ring_fd < 0) {
+            return;
+        }
+
+        std::vector<iovec> iovecs;
+
+        try {
+            iovecs.resize(BufferCount);
+        } catch (const std::bad_alloc&) {
+            return;
+        }
+
+        for (std::size_t i = 0; i < BufferCount; ++i) {
+            iovecs[i].iov_base = region_ + i * stride_;
+            iovecs[i].iov_len = BufferSize;
+        }
+
+        if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS,
+                    iovecs.data(), static_cast<unsigned>(BufferCount)) == 0) {
+            ring_fd_ = ring_fd;
+        }
+    }
+
+    void unregister_buffers() noexcept {
+        if (ring_fd_ >= 0) {
+            syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_BUFFERS,
+                    nullptr, 0u);
+        }
+    }
+#else
+    void register_buffers(int) noexcept { }
+
+    void unregister_buffers() noexcept { }
+#endif
+
+    std::size_t stride_;
+    std::uint8_t *region_;
+    int ring_fd_ = -1;
+    std::array<std::uint32_t, BufferCount> free_;
+    std::size_t num_free_ = 0;
+    std::bitset<BufferCount> in_use_;
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef GREGJM_KEY_PAYLOAD_HEAP_HPP
+#define GREGJM_KEY_PAYLOAD_HEAP_HPP
+
+#include "fibonacci_heap.hpp" // gregjm::FibonacciHeap
+#include "heap_stats.hpp" // gregjm::DummyHeapStats
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <functional> // std::less, std::invoke
+#include <memory> // std::allocator, std::allocator_traits
+#include <optional> // std::optional
+#include <type_traits> // std::is_same_v, std::is_nothrow_invocable_v,
+                       // std::is_nothrow_swappable_v
+#include <utility> // std::forward, std::move, std::in_place
+#include <vector> // std::vector
+
+namespace gregjm {
+namespace detail {
+
+// what a KeyPayloadHeap keeps in its heap: the key, and where the payload
+// is
+template <typename Key>
+struct KeyedSlot {
+    Key key;
+    std::size_t slot;
+};
+
+template <typename Compare>
+struct KeyedSlotCompare {
+    template <typename Key>
+    bool operator()(const KeyedSlot<Key> &lhs, const KeyedSlot<Key> &rhs) const
+    noexcept(std::is_nothrow_invocable_v<const Compare&, const Key&,
+                                         const Key&>) {
+        return std::invoke(compare, lhs.key, rhs.key);
+    }
+
+    Compare compare;
+};
+
+} // namespace detail
+
+// a FibonacciHeap of keys whose payloads are stored apart from the heap, in
+// an array of slots indexed by the nodes. melding and consolidating only
+// touch nodes, which stay small however large the payloads are, so this
+// beats FibonacciHeap<T> when T is heavy and its key is a small part of it.
+// freed slots are reused by later pushes, so the array only grows with the
+// most elements held at once
+//
+// the handles returned by push stay valid until their element is popped or
+// erased. to keep the top's payload, move it out before popping
+template <typename Key, typename Payload, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Payload>,
+          typename Stats = DummyHeapStats>
+class KeyPayloadHeap {
+    static_assert(
+        std::is_same_v<
+            Payload, typename std::allocator_traits<Allocator>::value_type
+        >, "Allocator value_type must be Payload"
+    );
+
+    using EntryT = detail::KeyedSlot<Key>;
+    using TraitsT = std::allocator_traits<Allocator>;
+    using EntryAllocT = typename TraitsT::template rebind_alloc<EntryT>;
+    using SlotT = std::optional<Payload>;
+    using SlotAllocT = typename TraitsT::template rebind_alloc<SlotT>;
+    using IndexAllocT = typename TraitsT::template rebind_alloc<std::size_t>;
+    using HeapT = FibonacciHeap<EntryT, detail::KeyedSlotCompare<Compare>,
+                                EntryAllocT, Stats>;
+
+public:
+    using key_type = Key;
+    using payload_type = Payload;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using stats_type = Stats;
+    using size_type = std::size_t;
+    using handle = typename HeapT::iterator;
+
+    explicit KeyPayloadHeap(const key_compare &comparator = key_compare{ },
+                            const allocator_type &allocator =
+                                allocator_type{ })
+    : heap_{ detail::KeyedSlotCompare<Compare>{ comparator },
+             EntryAllocT{ allocator } },
+      payloads_{ SlotAllocT{ allocator } },
+      free_{ IndexAllocT{ allocator } } { }
+
+    explicit KeyPayloadHeap(const allocator_type &allocator)
+    : KeyPayloadHeap{ key_compare{ }, allocator } { }
+
+    KeyPayloadHeap(const KeyPayloadHeap &other) = delete;
+
+    KeyPayloadHeap& operator=(const KeyPayloadHeap &other) = delete;
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type{ payloads_.get_allocator() };
+    }
+
+    const key_type& top_key() const {
+        return heap_.top().key;
+    }
+
+    payload_type& top_payload() {
+        return *payloads_[heap_.top().slot];
+    }
+
+    const payload_type& top_payload() const {
+        return *payloads_[heap_.top().slot];
+    }
+
+    const key_type& key(const handle element) const {
+        return (*element).key;
+    }
+
+    payload_type& payload(const handle element) {
+        return *payloads_[(*element).slot];
+    }
+
+    const payload_type& payload(const handle element) const {
+        return *payloads_[(*element).slot];
+    }
+
+    bool empty() const noexcept {
+        return heap_.empty();
+    }
+
+    size_type size() const noexcept {
+        return heap_.size();
+    }
+
+    const stats_type& stats() const noexcept {
+        return heap_.stats();
+    }
+
+    void reset_stats() {
+        heap_.reset_stats();
+    }
+
+    void clear() noexcept {
+        heap_.clear();
+        payloads_.clear();
+        free_.clear();
+    }
+
+    template <typename ...Args>
+    handle emplace(const key_type &key, Args &&...args) {
+        const std::size_t slot = acquire(std::forward<Args>(args)...);
+
+        try {
+            return heap_.push(EntryT{ key, slot });
+        } catch (...) {
+            release(slot);
+
+            throw;
+        }
+    }
+
+    handle push(const key_type &key, const payload_type &payload) {
+        return emplace(key, payload);
+    }
+
+    handle push(const key_type &key, payload_type &&payload) {
+        return emplace(key, std::move(payload));
+    }
+
+    // destroys the top's payload
+    void pop() {
+        const std::size_t slot = heap_.top().slot;
+        heap_.pop();
+        release(slot);
+    }
+
+    // moves element to where key puts it; its payload stays where it is
+    void update_key(const handle element, const key_type &key) {
+        heap_.update(element, [&key](EntryT &entry) { entry.key = key; });
+    }
+
+    void erase(const handle element) {
+        const std::size_t slot = (*element).slot;
+        heap_.erase(element);
+        release(slot);
+    }
+
+    void swap(KeyPayloadHeap &other)
+    noexcept(std::is_nothrow_swappable_v<HeapT>) {
+        heap_.swap(other.heap_);
+        payloads_.swap(other.payloads_);
+        free_.swap(other.free_);
+    }
+
+private:
+    // constructs a payload in a free slot, or a new one at the end
+    template <typename ...Args>
+    std::size_t acquire(Args &&...args) {
+        if (not free_.empty()) {
+            const std::size_t slot = free_.back();
+            payloads_[slot].emplace(std::forward<Args>(args)...);
+            free_.pop_back();
+
+            return slot;
+        }
+
+        payloads_.emplace_back(std::in_place, std::forward<Args>(args)...);
+
+        try {
+            // so that release never has to allocate. free_ follows
+            // payloads_'s capacity, so it grows geometrically too
+            if (free_.capacity() < payloads_.size()) {
+                free_.reserve(payloads_.capacity());
+            }
+        } catch (...) {
+            payloads_.pop_back();
+
+            throw;
+        }
+
+        return payloads_.size() - 1;
+    }
+
+    void release(const std::size_t slot) noexcept {
+        assert(payloads_[slot]);
+
+        payloads_[slot].reset();
+        free_.push_back(slot);
+    }
+
+    HeapT heap_;
+    std::vector<SlotT, SlotAllocT> payloads_;
+    std::vector<std::size_t, IndexAllocT> free_;
+};
+
+template <typename Key, typename Payload, typename Compare,
+          typename Allocator, typename Stats>
+void swap(KeyPayloadHeap<Key, Payload, Compare, Allocator, Stats> &lhs,
+          KeyPayloadHeap<Key, Payload, Compare, Allocator, Stats> &rhs)
+noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+} // namespace gregjm
+
+#endif
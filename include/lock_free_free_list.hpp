@@ -0,0 +1,217 @@
+#ifndef GREGJM_LOCK_FREE_FREE_LIST_HPP
+#define GREGJM_LOCK_FREE_FREE_LIST_HPP
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t, std::uintptr_t
+#include <atomic> // std::atomic, std::memory_order
+#include <new> // placement new
+
+namespace gregjm {
+
+// lives in the first bytes of a free block, so blocks pushed onto a free list
+// must be at least sizeof(FreeListNode) bytes and suitably aligned
+struct FreeListNode {
+    explicit FreeListNode(FreeListNode *const next_node = nullptr) noexcept
+    : next{ next_node } { }
+
+    std::atomic<FreeListNode*> next;
+};
+
+// a privately owned, nullptr terminated run of nodes
+struct FreeListChain {
+    // turns memory into a node at the front of the chain
+    void push_front(void *const memory) noexcept {
+        assert(memory);
+
+        FreeListNode *const node = new (memory) FreeListNode{ first };
+
+        if (not first) {
+            last = node;
+        }
+
+        first = node;
+        ++size;
+    }
+
+    // assumes nonempty
+    void* pop_front() noexcept {
+        assert(first);
+
+        FreeListNode *const node = first;
+        first = node->next.load(std::memory_order_relaxed);
+
+        if (not first) {
+            last = nullptr;
+        }
+
+        --size;
+
+        return node;
+    }
+
+    bool empty() const noexcept {
+        return first == nullptr;
+    }
+
+    FreeListNode *first = nullptr;
+    FreeListNode *last = nullptr;
+    std::size_t size = 0;
+};
+
+// Treiber stack of free blocks. the head is a single 64-bit word holding the
+// pointer and a modification tag that is bumped on every successful CAS, so a
+// head that was popped and pushed back (ABA) never compares equal. on 64-bit
+// targets the tag takes the upper 16 bits, which assumes 48-bit user space
+// addresses as on x86-64 and AArch64; 32-bit targets get a 32-bit tag
+//
+// pop reads the next pointer of a node that another thread may pop and reuse
+// at the same time, so pushed memory must stay mapped for as long as the list
+// is in use, which holds for blocks carved out of an allocator's own regions
+class LockFreeFreeList {
+    using TaggedT = std::uint64_t;
+
+    static constexpr unsigned POINTER_BITS =
+        (sizeof(void*) == 8) ? 48 : 32;
+    static constexpr TaggedT POINTER_MASK =
+        (TaggedT{ 1 } << POINTER_BITS) - 1;
+
+public:
+    LockFreeFreeList() noexcept = default;
+
+    LockFreeFreeList(const LockFreeFreeList &other) = delete;
+
+    LockFreeFreeList& operator=(const LockFreeFreeList &other) = delete;
+
+    void push(void *const memory) noexcept {
+        FreeListChain chain;
+        chain.push_front(memory);
+
+        push_chain(chain);
+    }
+
+    // links an entire chain in with a single CAS
+    void push_chain(const FreeListChain chain) noexcept {
+        if (chain.empty()) {
+            return;
+        }
+
+        assert((reinterpret_cast<std::uintptr_t>(chain.first)
+                & ~POINTER_MASK) == 0);
+
+        TaggedT head = head_.load(std::memory_order_relaxed);
+
+        do {
+            chain.last->next.store(pointer(head), std::memory_order_relaxed);
+        } while (not head_.compare_exchange_weak(head,
+                                                 pack(chain.first, head),
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    }
+
+    // returns nullptr if the list is empty
+    void* pop() noexcept {
+        TaggedT head = head_.load(std::memory_order_acquire);
+
+        while (FreeListNode *const node = pointer(head)) {
+            FreeListNode *const next =
+                node->next.load(std::memory_order_relaxed);
+
+            if (head_.compare_exchange_weak(head, pack(next, head),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                return node;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // detaches the whole list with a single CAS
+    FreeListChain pop_all() noexcept {
+        TaggedT head = head_.load(std::memory_order_relaxed);
+
+        while (not head_.compare_exchange_weak(head, pack(nullptr, head),
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) { }
+
+        FreeListChain chain;
+        chain.first = pointer(head);
+
+        // the chain is ours now, so walking it is safe
+        for (FreeListNode *node = chain.first; node;
+             node = node->next.load(std::memory_order_relaxed)) {
+            chain.last = node;
+            ++chain.size;
+        }
+
+        return chain;
+    }
+
+    // pops up to max_count nodes. walking a shared list could follow a
+    // pointer out of a block that was just reused, so this takes the whole
+    // list and gives back whatever is past max_count
+    FreeListChain pop_chain(const std::size_t max_count) noexcept {
+        FreeListChain chain = pop_all();
+
+        if (chain.size <= max_count) {
+            return chain;
+        }
+
+        if (max_count == 0) {
+            push_chain(chain);
+
+            return FreeListChain{ };
+        }
+
+        FreeListNode *last = chain.first;
+
+        for (std::size_t i = 1; i < max_count; ++i) {
+            last = last->next.load(std::memory_order_relaxed);
+        }
+
+        FreeListChain rest;
+        rest.first = last->next.load(std::memory_order_relaxed);
+        rest.last = chain.last;
+        rest.size = chain.size - max_count;
+
+        last->next.store(nullptr, std::memory_order_relaxed);
+        chain.last = last;
+        chain.size = max_count;
+
+        push_chain(rest);
+
+        return chain;
+    }
+
+    bool empty() const noexcept {
+        return pointer(head_.load(std::memory_order_relaxed)) == nullptr;
+    }
+
+private:
+    static FreeListNode* pointer(const TaggedT tagged) noexcept {
+        return reinterpret_cast<FreeListNode*>(
+            static_cast<std::uintptr_t>(tagged & POINTER_MASK)
+        );
+    }
+
+    // packs node with the tag after previous's. pop may pack garbage read
+    // from a node that was popped and reused under it; the CAS fails then,
+    // so the stray bits are masked off instead of asserted on
+    static TaggedT pack(FreeListNode *const node,
+                        const TaggedT previous) noexcept {
+        const auto address = static_cast<TaggedT>(
+            reinterpret_cast<std::uintptr_t>(node)
+        );
+
+        const TaggedT tag = (previous >> POINTER_BITS) + 1;
+
+        return (address & POINTER_MASK) | (tag << POINTER_BITS);
+    }
+
+    std::atomic<TaggedT> head_{ 0 };
+};
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef GREGJM_MIRRORED_RING_BUFFER_HPP
+#define GREGJM_MIRRORED_RING_BUFFER_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "address_range.hpp" // gregjm::in_address_range
+#include "virtual_memory.hpp" // gregjm::page_size, gregjm::reserve_memory,
+                              // gregjm::release_memory,
+                              // gregjm::create_shared_memory
+
+#include <algorithm> // std::min
+#include <atomic> // std::atomic
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
+#include <cstring> // std::memcpy
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h> // CreateFileMappingW, MapViewOfFileEx,
+                     // UnmapViewOfFile, CloseHandle
+#else
+#include <sys/mman.h> // mmap
+#include <unistd.h> // close
+#endif
+
+namespace gregjm {
+namespace detail {
+
+// the granularity at which the same pages can be mapped at a chosen address
+inline std::size_t mirror_granularity() noexcept {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return static_cast<std::size_t>(info.dwAllocationGranularity);
+#else
+    return page_size();
+#endif
+}
+
+#if defined(_WIN32)
+// nothing stops another thread from mapping into the hole between releasing
+// the reservation and mapping the views, so this tries a few times
+inline void* map_mirrored(const std::size_t size) {
+    constexpr int MAX_ATTEMPTS = 16;
+
+    const auto size64 = static_cast<unsigned long long>(size);
+    const HANDLE mapping =
+        CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                           static_cast<DWORD>(size64 >> 32),
+                           static_cast<DWORD>(size64 & 0xffffffff), nullptr);
+
+    if (not mapping) {
+        throw BadAllocationException{ };
+    }
+
+    for (int i = 0; i < MAX_ATTEMPTS; ++i) {
+        auto *const base = static_cast<std::uint8_t*>(
+            VirtualAlloc(nullptr, 2 * size, MEM_RESERVE, PAGE_NOACCESS)
+        );
+
+        if (not base) {
+            break;
+        }
+
+        VirtualFree(base, 0, MEM_RELEASE);
+
+        void *const first = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS,
+                                            0, 0, size, base);
+        void *const second = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS,
+                                             0, 0, size, base + size);
+
+        if (first == base and second == base + size) {
+            // the views keep the mapping alive
+            CloseHandle(mapping);
+
+            return base;
+        }
+
+        if (first) {
+            UnmapViewOfFile(first);
+        }
+
+        if (second) {
+            UnmapViewOfFile(second);
+        }
+    }
+
+    CloseHandle(mapping);
+
+    throw BadAllocationException{ };
+}
+
+inline void unmap_mirrored(void *const memory,
+                           const std::size_t size) noexcept {
+    UnmapViewOfFile(memory);
+    UnmapViewOfFile(static_cast<std::uint8_t*>(memory) + size);
+}
+#else
+// maps both views over a reservation, so the pair can't collide with other
+// mappings
+inline void* map_mirrored(const std::size_t size) {
+    const int fd = create_shared_memory(size);
+    auto *base = static_cast<std::uint8_t*>(nullptr);
+
+    try {
+        base = static_cast<std::uint8_t*>(reserve_memory(2 * size));
+    } catch (...) {
+        close(fd);
+
+        throw;
+    }
+
+    const bool mapped =
+        mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             fd, 0) != MAP_FAILED
+        and mmap(base + size, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+
+    // the mappings keep the pages alive
+    close(fd);
+
+    if (not mapped) {
+        release_memory(base, 2 * size);
+
+        throw BadAllocationException{ };
+    }
+
+    return base;
+}
+
+inline void unmap_mirrored(void *const memory,
+                           const std::size_t size) noexcept {
+    release_memory(memory, 2 * size);
+}
+#endif
+
+} // namespace detail
+
+// a ring buffer whose pages are mapped twice, back to back, so that any
+// span of up to capacity() bytes starting anywhere in the first copy is
+// contiguous in memory. writers and readers never split a record at the
+// wraparound, and records can be parsed in place
+//
+// as a byte stream, a producer writes into write_block() and commit()s what
+// it wrote, and a consumer reads from read_block() and consume()s what it
+// read. as an allocator, blocks are handed out from the write side in order,
+// and deallocating a block releases it along with every block allocated
+// before it. one producer and one consumer may run concurrently without
+// locking
+class MirroredRingBuffer final : public PolymorphicAllocator {
+public:
+    // capacity is rounded up to a multiple of the page size, or the
+    // allocation granularity on Windows
+    explicit MirroredRingBuffer(const std::size_t capacity)
+    : capacity_{ round_up(capacity, detail::mirror_granularity()) },
+      memory_{ static_cast<std::uint8_t*>(detail::map_mirrored(capacity_)) }
+    { }
+
+    MirroredRingBuffer(const MirroredRingBuffer &other) = delete;
+
+    MirroredRingBuffer& operator=(const MirroredRingBuffer &other) = delete;
+
+    virtual ~MirroredRingBuffer() {
+        detail::unmap_mirrored(memory_, capacity_);
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    // bytes written but not yet consumed
+    std::size_t size() const noexcept {
+        return head_.load(std::memory_order_acquire)
+               - tail_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // producer side: all the free space, in one piece
+    MemoryBlock write_block() const noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+        return MemoryBlock{ at(head), capacity_ - (head - tail) };
+    }
+
+    // producer side: publishes count bytes written to write_block()
+    void commit(const std::size_t count) noexcept {
+        assert(count <= write_block().size);
+
+        head_.store(head_.load(std::memory_order_relaxed) + count,
+                    std::memory_order_release);
+    }
+
+    // consumer side: everything written and not yet consumed, in one piece
+    MemoryBlock read_block() const noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+
+        return MemoryBlock{ at(tail), head - tail };
+    }
+
+    // consumer side: frees count bytes from the front of read_block()
+    void consume(const std::size_t count) noexcept {
+        assert(count <= read_block().size);
+
+        tail_.store(tail_.load(std::memory_order_relaxed) + count,
+                    std::memory_order_release);
+    }
+
+    // both copies of the buffer
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ memory_, 2 * capacity_ };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t padding = padding_at(head, alignment);
+        const MemoryBlock space = write_block();
+
+        if (padding > space.size or size > space.size - padding) {
+            throw BadAllocationException{ };
+        }
+
+        commit(padding + size);
+
+        return MemoryBlock{ at(head + padding), size };
+    }
+
+    // the newest block grows in place; anything else is copied to a new
+    // block and released along with it
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        const std::size_t end = stream_end(block);
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if (end == head and is_aligned(block.memory, alignment)) {
+            const std::size_t available = write_block().size;
+
+            if (size <= block.size) {
+                head_.store(head - (block.size - size),
+                            std::memory_order_release);
+
+                return MemoryBlock{ block.memory, size };
+            }
+
+            if (size - block.size <= available) {
+                commit(size - block.size);
+
+                return MemoryBlock{ block.memory, size };
+            }
+
+            throw BadAllocationException{ };
+        }
+
+        const MemoryBlock realloc_block = allocate_impl(size, alignment);
+        std::memcpy(realloc_block.memory, block.memory,
+                    std::min(size, block.size));
+
+        return realloc_block;
+    }
+
+    // releases block and everything allocated before it. blocks that were
+    // already released along with a later block are ignored
+    void deallocate_impl(const MemoryBlock block) override {
+        const std::size_t end = stream_end(block);
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (end != tail) {
+            consume(end - tail);
+        }
+    }
+
+    // not safe to call while the producer or consumer are running
+    void deallocate_all_impl() override {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    std::size_t max_size_impl() const override {
+        return write_block().size;
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        return in_address_range(address_range(), block.memory);
+    }
+
+    // the stream position just past block, which must lie between the tail
+    // and the head
+    std::size_t stream_end(const MemoryBlock block) const {
+        if (not owns_impl(block)) {
+            throw NotOwnedException{ };
+        }
+
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const auto offset = static_cast<std::size_t>(
+            static_cast<std::uint8_t*>(block.memory) - memory_
+        );
+        const std::size_t distance =
+            (offset % capacity_ + capacity_ - tail % capacity_) % capacity_;
+
+        // a block that was already released wraps around to past the head
+        if (distance > head - tail or block.size > head - tail - distance) {
+            return tail;
+        }
+
+        return tail + distance + block.size;
+    }
+
+    std::size_t padding_at(const std::size_t position,
+                           const std::size_t alignment) const {
+        if (alignment <= 1) {
+            return 0;
+        }
+
+        // the buffer is page-aligned, so any larger alignment would only
+        // hold at some positions
+        if (alignment > detail::mirror_granularity()) {
+            throw BadAllocationException{ };
+        }
+
+        return round_up(position, alignment) - position;
+    }
+
+    std::uint8_t* at(const std::size_t position) const noexcept {
+        return memory_ + position % capacity_;
+    }
+
+    static bool is_aligned(const void *const memory,
+                           const std::size_t alignment) noexcept {
+        return alignment <= 1
+               or reinterpret_cast<std::uintptr_t>(memory) % alignment == 0;
+    }
+
+    static std::size_t round_up(const std::size_t value,
+                                const std::size_t multiple) noexcept {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    std::size_t capacity_;
+    std::uint8_t *memory_;
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+};
+
+} // namespace gregjm
+
+#endif
@@ -5,74 +5,221 @@
                                      // gregjm::MemoryBlock,
                                      // gregjm::PolymorphicAllocatorAdaptor,
                                      // gregjm::NotOwnedException
-#include "stack_allocator.hpp" // gregjm::StackAllocator
 #include "dummy_mutex.hpp" // gregjm::DummyMutex
 
 #include <cstddef> // std::size_t, std::ptrdiff_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
 #include <cstring> // std::memcpy
-#include <algorithm> // std::make_heap, std::push_heap, std::find_if
-#include <memory> // std::unique_ptr
+#include <algorithm> // std::lower_bound, std::upper_bound, std::min,
+                     // std::max
+#include <deque> // std::deque
+#include <iterator> // std::prev
 #include <mutex> // std::scoped_lock
-#include <queue> // std::priority_queue
 #include <utility> // std::swap, std::forward
+#include <vector> // std::vector
 #include <type_traits> // std::is_constructible_v,
                        // std::is_nothrow_constructible_v
 
 namespace gregjm {
 namespace detail {
 
-// compare s.t. we get a maxheap based on the remaining size in a heap
-struct PoolAllocatorComparator {
-    template <std::size_t N, typename D1, std::size_t M = N, typename D2>
-    bool operator()(const std::unique_ptr<StackAllocator<N>, D1> &lhs,
-                    const std::unique_ptr<StackAllocator<M>, D2> &rhs) const {
-        return lhs->max_size() < rhs->max_size();
-    }
-};
+// bookkeeping for a single pool, kept out of line so that a pool's region is
+// nothing but user data. works like a StackAllocator over [begin, begin + N)
+template <typename Mutex>
+class PoolHeader {
+    using LockT = std::scoped_lock<Mutex>;
 
-template <typename Allocator>
-class PoolAllocatorDeleter {
 public:
-    PoolAllocatorDeleter() = delete;
+    PoolHeader(const MemoryBlock region, void *const begin,
+               const std::size_t size) noexcept
+    : region_{ region }, begin_{ static_cast<std::uint8_t*>(begin) },
+      stack_pointer_{ begin_ }, size_{ size }, max_size_{ size } { }
+
+    PoolHeader(const PoolHeader &other) = delete;
+
+    PoolHeader& operator=(const PoolHeader &other) = delete;
+
+    MemoryBlock allocate(const std::size_t size, const std::size_t alignment) {
+        const LockT lock{ mutex_ };
+
+        return allocate_locked(size, alignment);
+    }
+
+    MemoryBlock reallocate(const MemoryBlock block, const std::size_t size,
+                           const std::size_t alignment) {
+        const LockT lock{ mutex_ };
+
+        if (not owns_locked(block)) {
+            throw NotOwnedException{ };
+        }
+
+        if (static_cast<std::uint8_t*>(block.memory) + block.size
+            == stack_pointer_) {
+            if (size < block.size) {
+                pop(block.size - size);
+            } else if (size - block.size > max_size_) {
+                throw BadAllocationException{ };
+            } else {
+                push(size - block.size);
+            }
+
+            return MemoryBlock{ block.memory, size };
+        }
+
+        const MemoryBlock realloc_block = allocate_locked(size, alignment);
+        std::memcpy(realloc_block.memory, block.memory,
+                    std::min(size, block.size));
+        deallocate_locked(block);
+
+        return realloc_block;
+    }
 
-    PoolAllocatorDeleter(Allocator &alloc) : alloc_{ &alloc } { }
+    void deallocate(const MemoryBlock block) {
+        const LockT lock{ mutex_ };
 
-    template <std::size_t N>
-    void operator()(StackAllocator<N> *const pool) {
-        pool->~StackAllocator<N>();
+        deallocate_locked(block);
+    }
 
-        const MemoryBlock block{ pool, sizeof(StackAllocator<N>) };
+    void deallocate_all() {
+        const LockT lock{ mutex_ };
 
-        alloc_->deallocate(block);
+        reset();
     }
 
+    std::size_t max_size() const {
+        const LockT lock{ mutex_ };
+
+        return max_size_;
+    }
+
+    bool owns(const MemoryBlock block) const {
+        const LockT lock{ mutex_ };
+
+        return owns_locked(block);
+    }
+
+    bool contains(const void *const memory) const noexcept {
+        const auto address = static_cast<const std::uint8_t*>(memory);
+
+        return address >= begin_ and address < begin_ + size_;
+    }
+
+    const void* begin() const noexcept {
+        return begin_;
+    }
+
+    MemoryBlock region() const noexcept {
+        return region_;
+    }
+
+    // position in the PoolAllocator heap, guarded by the PoolAllocator's lock
+    std::ptrdiff_t heap_index = 0;
+
 private:
-    Allocator *alloc_;
+    // assumes resources are locked
+    MemoryBlock allocate_locked(const std::size_t size,
+                                const std::size_t alignment) {
+        const auto sp = reinterpret_cast<std::uintptr_t>(stack_pointer_);
+        const auto modulo = sp % alignment;
+        const std::size_t padding = (modulo == 0) ? 0 : alignment - modulo;
+
+        if (padding > max_size_ or size > max_size_ - padding) {
+            throw BadAllocationException{ };
+        }
+
+        push(padding);
+        const MemoryBlock block{ stack_pointer_, size };
+        push(size);
+
+        ++allocated_;
+
+        return block;
+    }
+
+    // assumes resources are locked
+    void deallocate_locked(const MemoryBlock block) {
+        if (not owns_locked(block)) {
+            throw NotOwnedException{ };
+        }
+
+        if (static_cast<std::uint8_t*>(block.memory) + block.size
+            == stack_pointer_) {
+            pop(block.size);
+        }
+
+        --allocated_;
+
+        if (allocated_ == 0) {
+            reset();
+        }
+    }
+
+    bool owns_locked(const MemoryBlock block) const noexcept {
+        const auto memory = static_cast<const std::uint8_t*>(block.memory);
+
+        return memory >= begin_ and memory < stack_pointer_;
+    }
+
+    void push(const std::size_t size) noexcept {
+        max_size_ -= size;
+        stack_pointer_ += size;
+    }
+
+    void pop(const std::size_t size) noexcept {
+        max_size_ += size;
+        stack_pointer_ -= size;
+    }
+
+    void reset() noexcept {
+        stack_pointer_ = begin_;
+        allocated_ = 0;
+        max_size_ = size_;
+    }
+
+    MemoryBlock region_;
+    std::uint8_t *begin_;
+    std::uint8_t *stack_pointer_;
+    std::size_t size_;
+    std::size_t max_size_;
+    std::size_t allocated_ = 0;
+    mutable Mutex mutex_;
 };
 
 } // namespace detail
 
-template <std::size_t PoolSize, typename Allocator, typename Mutex = DummyMutex>
+// pools are PoolSize bytes of user data aligned to PoolAlignment (a page by
+// default; 2 MiB lets transparent huge pages back a whole pool). their
+// headers live in a separate, densely packed deque and are found from a
+// pointer by binary search over the pool base addresses. when PoolSize <=
+// PoolAlignment a pool's base is just the pointer with its low bits masked
+// off.
+//
+// mutex_ only guards the pool heap and index; each pool header has its own
+// Mutex, so threads allocating from different pools don't serialize and no
+// pool operation is ever made while holding mutex_ except on a fresh pool.
+// lock order is always mutex_, then a pool's mutex
+template <std::size_t PoolSize, typename Allocator, typename Mutex = DummyMutex,
+          std::size_t PoolAlignment = 4096>
 class PoolAllocator final : public PolymorphicAllocator {
+    static_assert(PoolAlignment != 0
+                  and (PoolAlignment & (PoolAlignment - 1)) == 0,
+                  "PoolAlignment must be a power of two");
+
     using LockT = std::scoped_lock<Mutex>;
-    using DoubleLockT = std::scoped_lock<Mutex, Mutex>;
-    using PoolT = StackAllocator<PoolSize>;
-    using OwnerT = std::unique_ptr<PoolT,
-                                   detail::PoolAllocatorDeleter<Allocator>>;
-    using VectorT = std::vector<OwnerT, PolymorphicAllocatorAdaptor<OwnerT>>;
+    using HeaderT = detail::PoolHeader<Mutex>;
+    using HeaderDequeT = std::deque<HeaderT,
+                                    PolymorphicAllocatorAdaptor<HeaderT>>;
+    using VectorT = std::vector<HeaderT*,
+                                PolymorphicAllocatorAdaptor<HeaderT*>>;
     using IterMutT = typename VectorT::iterator;
     using IterT = typename VectorT::const_iterator;
 
 public:
     PoolAllocator(const PoolAllocator &other) = delete;
 
-    PoolAllocator(PoolAllocator &&other) : mutex_{ } {
-        const DoubleLockT lock{ mutex_, other.mutex_ };
-
-        alloc_ = std::move(other.alloc_);
-        deleter_ = std::move(other.deleter_);
-        pools_ = std::move(other.pools_);
-    }
+    // the containers allocate through alloc_, so they can't follow it to
+    // another PoolAllocator
+    PoolAllocator(PoolAllocator &&other) = delete;
 
     template <typename ...Args,
               typename = std::enable_if_t<std::is_constructible_v<Allocator,
@@ -84,21 +231,35 @@ public:
 
     PoolAllocator& operator=(const PoolAllocator &other) = delete;
 
-    PoolAllocator& operator=(PoolAllocator &&other) {
-        if (this == &other) {
-            return *this;
-        }
+    PoolAllocator& operator=(PoolAllocator &&other) = delete;
+
+    virtual ~PoolAllocator() {
+        release_regions();
+    }
 
-        const LockT lock{ mutex_, other.mutex_ };
+    // creates empty pools until there are at least count of them and
+    // prefaults each new one by calling prefault(memory, size) on its
+    // region, usually with a Prefaulter from virtual_memory.hpp, so that
+    // startup pays for the page faults instead of the first allocations.
+    // returns how many pools were created
+    template <typename Prefault>
+    std::size_t reserve(const std::size_t count, Prefault &&prefault) {
+        const LockT lock{ mutex_ };
 
-        alloc_ = std::move(other.alloc_);
-        deleter_ = std::move(other.deleter_);
-        pools_ = std::move(other.pools_);
+        pools_.reserve(count);
+        index_.reserve(count);
 
-        return *this;
-    }
+        std::size_t created = 0;
+
+        for (; pools_.size() < count; ++created) {
+            const HeaderT &header = add_pool();
+            const MemoryBlock region = header.region();
+
+            prefault(region.memory, region.size);
+        }
 
-    virtual ~PoolAllocator() = default;
+        return created;
+    }
 
 private:
     MemoryBlock allocate_impl(const std::size_t size,
@@ -107,70 +268,56 @@ private:
             throw BadAllocationException{ };
         }
 
-        const LockT lock{ mutex_ };
-
-        if (pools_.empty()) {
-            return allocate_new(size, alignment);
-        }
-
-        try {
-            const MemoryBlock block =
-                pools_.front()->allocate(size, alignment);
+        HeaderT *const front = front_pool();
 
-            fix_down();
+        if (front) {
+            try {
+                const MemoryBlock block = front->allocate(size, alignment);
+                reposition(*front);
 
-            return block;
-        } catch (const BadAllocationException&) {
-            return allocate_new(size, alignment);
+                return block;
+            } catch (const BadAllocationException&) { }
         }
+
+        return allocate_new(size, alignment);
     }
 
     MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
                                 const std::size_t alignment) override {
-        const LockT lock{ mutex_ };
-
-        const auto owner_iter = get_owner_iter(block);
+        HeaderT &owner = get_owner(block);
 
-        if (owner_iter == pools_.end()) {
-            throw NotOwnedException{ };
-        }
+        try {
+            const MemoryBlock realloc_block =
+                owner.reallocate(block, size, alignment);
+            reposition(owner);
 
-        auto &owner = **owner_iter;
+            return realloc_block;
+        } catch (const BadAllocationException&) { }
 
-        try {
-            return owner.reallocate(block, size, alignment);
-        } catch (const BadAllocationException&) {
-            const MemoryBlock new_block = allocate(size, alignment);
+        // no locks are held here, so allocating can't deadlock
+        const MemoryBlock new_block = allocate(size, alignment);
 
-            std::memcpy(new_block.memory, block.memory, block.size);
+        std::memcpy(new_block.memory, block.memory, std::min(size, block.size));
 
-            owner.deallocate(block);
-            fix_up(owner_iter);
+        owner.deallocate(block);
+        reposition(owner);
 
-            return new_block;
-        }
+        return new_block;
     }
 
     void deallocate_impl(const MemoryBlock block) override {
-        const LockT lock{ mutex_ };
-
-        const auto owner_iter = get_owner_iter(block);
-
-        if (owner_iter == pools_.end()) {
-            throw NotOwnedException{ };
-        }
+        HeaderT &owner = get_owner(block);
 
-        auto &owner = **owner_iter;
-        
         owner.deallocate(block);
-        fix_up(owner_iter);
+        reposition(owner);
     }
 
     void deallocate_all_impl() override {
         const LockT lock{ mutex_ };
 
-        for (const auto &pool_ptr : pools_) {
-            pool_ptr->deallocate_all();
+        // every pool ends up with PoolSize bytes free, so the heap stays valid
+        for (HeaderT &header : headers_) {
+            header.deallocate_all();
         }
     }
 
@@ -179,43 +326,186 @@ private:
     }
 
     bool owns_impl(const MemoryBlock block) const override {
+        const HeaderT *const owner = find_owner(block.memory);
+
+        return owner and owner->owns(block);
+    }
+
+    // headers are only destroyed along with the PoolAllocator, so the returned
+    // pointer stays valid after mutex_ is released
+    HeaderT* front_pool() const {
+        const LockT lock{ mutex_ };
+
+        if (pools_.empty()) {
+            return nullptr;
+        }
+
+        return pools_.front();
+    }
+
+    HeaderT& get_owner(const MemoryBlock block) {
+        HeaderT *const owner = find_owner(block.memory);
+
+        if (not owner) {
+            throw NotOwnedException{ };
+        }
+
+        return *owner;
+    }
+
+    HeaderT* find_owner(const void *const memory) const {
+        const auto address = reinterpret_cast<std::uintptr_t>(memory);
+
         const LockT lock{ mutex_ };
 
-        for (const auto &pool_ptr : pools_) {
-            if (pool_ptr->owns(block)) {
-                return true;
+        if constexpr (PoolSize <= PoolAlignment) {
+            const auto base = address & ~(PoolAlignment - 1);
+            const auto iter = std::lower_bound(index_.cbegin(), index_.cend(),
+                                               base, base_less);
+
+            if (iter == index_.cend()
+                or reinterpret_cast<std::uintptr_t>((*iter)->begin()) != base) {
+                return nullptr;
+            }
+
+            return *iter;
+        } else {
+            auto iter = std::upper_bound(index_.cbegin(), index_.cend(),
+                                         address, address_less);
+
+            if (iter == index_.cbegin()) {
+                return nullptr;
             }
+
+            --iter;
+
+            if (not (*iter)->contains(memory)) {
+                return nullptr;
+            }
+
+            return *iter;
         }
+    }
 
-        return false;
+    static bool base_less(const HeaderT *const header,
+                          const std::uintptr_t address) noexcept {
+        return reinterpret_cast<std::uintptr_t>(header->begin()) < address;
+    }
+
+    static bool address_less(const std::uintptr_t address,
+                             const HeaderT *const header) noexcept {
+        return address < reinterpret_cast<std::uintptr_t>(header->begin());
     }
 
     // creates a new pool and allocates out of it
     // assumes count <= PoolSize
-    // assumes we have a lock
     MemoryBlock allocate_new(const std::size_t count,
                              const std::size_t alignment) {
-        const MemoryBlock pool_block = alloc_.allocate(sizeof(PoolT),
-                                                       alignof(PoolT));
-
-        auto pool = new (pool_block.memory) PoolT{ };
+        const LockT lock{ mutex_ };
 
-        const MemoryBlock allocated_block =
-            pool->allocate(count, alignment);
+        reserve_one_more(pools_);
+        reserve_one_more(index_);
 
-        pools_.emplace_back(pool,
-                            detail::PoolAllocatorDeleter<Allocator>{ alloc_ });
-        std::push_heap(pools_.begin(), pools_.end(),
-                       detail::PoolAllocatorComparator{ });
+        HeaderT &header = add_pool();
+        const MemoryBlock allocated_block = header.allocate(count, alignment);
+        fix_down(pools_.begin() + header.heap_index);
 
         return allocated_block;
     }
 
-    IterMutT get_owner_iter(const MemoryBlock block) {
-        return std::find_if(pools_.begin(), pools_.end(),
-                            [block](const OwnerT &owner) {
-                                return owner->owns(block);
-                            });
+    // grows by doubling, so that adding n pools one at a time is O(n)
+    static void reserve_one_more(VectorT &vector) {
+        if (vector.size() == vector.capacity()) {
+            vector.reserve(std::max(2 * vector.size(), std::size_t{ 1 }));
+        }
+    }
+
+    // creates an empty pool and puts it in the heap and index
+    // assumes we have a lock and that pools_ and index_ have room for one
+    // more element, so that nothing after the header is created can throw
+    HeaderT& add_pool() {
+        const MemoryBlock region = allocate_region();
+        HeaderT *header;
+
+        try {
+            header = &headers_.emplace_back(region, align_up(region.memory),
+                                            PoolSize);
+        } catch (...) {
+            alloc_.deallocate(region);
+
+            throw;
+        }
+
+        index_.insert(std::upper_bound(index_.begin(), index_.end(),
+                                       reinterpret_cast<std::uintptr_t>(
+                                           header->begin()
+                                       ),
+                                       address_less),
+                      header);
+
+        header->heap_index = static_cast<std::ptrdiff_t>(pools_.size());
+        pools_.push_back(header);
+        fix_up(std::prev(pools_.end()));
+
+        return *header;
+    }
+
+    // asks alloc_ for an aligned region first and only overallocates if it
+    // didn't honor the alignment
+    MemoryBlock allocate_region() {
+        const MemoryBlock region = alloc_.allocate(PoolSize, PoolAlignment);
+
+        if (align_up(region.memory) == region.memory) {
+            return region;
+        }
+
+        alloc_.deallocate(region);
+
+        return alloc_.allocate(PoolSize + PoolAlignment - 1, PoolAlignment);
+    }
+
+    static void* align_up(void *const memory) noexcept {
+        const auto address = reinterpret_cast<std::uintptr_t>(memory);
+        const auto aligned = (address + PoolAlignment - 1)
+                             & ~(PoolAlignment - 1);
+
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // assumes we have a lock or are being destroyed
+    void release_regions() {
+        for (const HeaderT &header : headers_) {
+            alloc_.deallocate(header.region());
+        }
+
+        pools_.clear();
+        index_.clear();
+        headers_.clear();
+    }
+
+    // restores the heap order after header's remaining size changed
+    // other threads may be using pools while we do this, so the order is
+    // only ever a hint of which pool has the most space
+    void reposition(const HeaderT &header) {
+        const LockT lock{ mutex_ };
+
+        const auto element = pools_.begin() + header.heap_index;
+
+        if (has_parent(element)
+            and (*parent(element))->max_size() < header.max_size()) {
+            fix_up(element);
+        } else {
+            fix_down(element);
+        }
+    }
+
+    // assumes we have a lock
+    void swap_elements(const IterMutT lhs, const IterMutT rhs) noexcept {
+        using std::swap;
+
+        swap(*lhs, *rhs);
+        (*lhs)->heap_index = lhs - pools_.begin();
+        (*rhs)->heap_index = rhs - pools_.begin();
     }
 
     bool has_left_child(const IterT element) const noexcept {
@@ -278,15 +568,13 @@ private:
         return pools_.cend();
     }
 
-    // update priority of front heap element
+    // update priority of given heap element
     // assumes we have a lock
-    // assumes nonempty
-    void fix_down() noexcept(std::is_nothrow_swappable_v<OwnerT>) {
-        const std::size_t size = pools_.front()->max_size();
-
-        for (auto current = pools_.begin(); current < pools_.end(); ) {
-            using std::swap;
+    // assumes element is dereferencable
+    void fix_down(const IterMutT element) {
+        const std::size_t size = (*element)->max_size();
 
+        for (auto current = element; current < pools_.end(); ) {
             const auto left = left_child_or(current);
             const auto right = right_child_or(current);
 
@@ -296,7 +584,7 @@ private:
                         break;
                     }
 
-                    swap(*right, *current);
+                    swap_elements(right, current);
 
                     current = right;
                 } else {
@@ -304,7 +592,7 @@ private:
                         break;
                     }
 
-                    swap(*left, *current);
+                    swap_elements(left, current);
 
                     current = left;
                 }
@@ -313,7 +601,7 @@ private:
                     break;
                 }
 
-                swap(*current, *left);
+                swap_elements(current, left);
                 current = left;
             } else {
                 break;
@@ -352,7 +640,7 @@ private:
     // update priority of given heap element
     // assumes we have a lock
     // assumes current is dereferencable
-    void fix_up(IterMutT element) noexcept(std::is_nothrow_swappable_v<OwnerT>) {
+    void fix_up(IterMutT element) {
         const auto size = (*element)->max_size();
 
         for (; element > pools_.begin(); ) {
@@ -363,9 +651,7 @@ private:
             }
 
             if ((*parent)->max_size() < size) {
-                using std::swap;
-
-                swap(*element, *parent);
+                swap_elements(element, parent);
                 element = parent;
             } else {
                 return;
@@ -375,8 +661,9 @@ private:
 
     mutable Mutex mutex_;
     Allocator alloc_;
-    detail::PoolAllocatorDeleter<Allocator> deleter_{ alloc_ };
-    VectorT pools_{ make_adaptor<OwnerT>(alloc_) };
+    HeaderDequeT headers_{ make_adaptor<HeaderT>(alloc_) };
+    VectorT pools_{ make_adaptor<HeaderT*>(alloc_) };
+    VectorT index_{ make_adaptor<HeaderT*>(alloc_) };
 };
 
 } // namespace gregjm
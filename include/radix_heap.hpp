@@ -0,0 +1,281 @@
+#ifndef GREGJM_RADIX_HEAP_HPP
+#define GREGJM_RADIX_HEAP_HPP
+
+#include <array> // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+#include <limits> // std::numeric_limits
+#include <memory> // std::allocator, std::allocator_traits
+#include <tuple> // std::forward_as_tuple
+#include <type_traits> // std::is_unsigned_v, std::is_same_v,
+                       // std::is_nothrow_move_assignable_v
+#include <utility> // std::pair, std::piecewise_construct, std::move,
+                   // std::forward, std::swap, std::as_const,
+                   // std::index_sequence, std::exchange
+#include <vector> // std::vector
+
+#if defined(_MSC_VER)
+#include <intrin.h> // _BitScanReverse64
+#endif
+
+namespace gregjm {
+namespace detail {
+
+// the number of bits needed to represent value; 0 for 0
+inline std::size_t bit_width(const std::uint64_t value) noexcept {
+    if (value == 0) {
+        return 0;
+    }
+
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+
+    return static_cast<std::size_t>(index) + 1;
+#elif defined(__GNUC__)
+    return 64 - static_cast<std::size_t>(__builtin_clzll(value));
+#else
+    std::size_t width = 0;
+
+    for (std::uint64_t rest = value; rest != 0; rest >>= 1) {
+        ++width;
+    }
+
+    return width;
+#endif
+}
+
+} // namespace detail
+
+// a min-heap for unsigned integer keys that never drop below the last key
+// popped, like event timestamps or the distances in Dijkstra's algorithm.
+// elements are bucketed by the highest bit where their key differs from the
+// last key popped; when the lowest bucket runs dry, the next one is spread
+// out below it. an element moves down at most once per bit of its key, so
+// pushes are O(1) and pops O(log C) amortized, where C is the largest gap
+// between keys
+//
+// unlike FibonacciHeap, top() is the smallest key and elements can't be
+// updated in place. pushing a key smaller than the last one popped is an
+// error
+template <typename Key, typename Value,
+          typename Allocator = std::allocator<std::pair<Key, Value>>>
+class RadixHeap {
+    static_assert(std::is_unsigned_v<Key>,
+                  "Key must be an unsigned integer type");
+    static_assert(std::numeric_limits<Key>::digits <= 64,
+                  "Key must be no wider than 64 bits");
+    static_assert(
+        std::is_same_v<
+            std::pair<Key, Value>,
+            typename std::allocator_traits<Allocator>::value_type
+        >, "Allocator value_type must be std::pair<Key, Value>"
+    );
+
+    // bucket 0 holds keys equal to the last key popped, bucket i keys whose
+    // highest differing bit is bit i - 1
+    static inline constexpr std::size_t NUM_BUCKETS =
+        std::numeric_limits<Key>::digits + 1;
+
+    using BucketT = std::vector<std::pair<Key, Value>, Allocator>;
+    using BucketArrayT = std::array<BucketT, NUM_BUCKETS>;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    RadixHeap() = default;
+
+    // every bucket draws its storage from a copy of allocator
+    explicit RadixHeap(const allocator_type &allocator)
+    : buckets_{ make_buckets(allocator,
+                             std::make_index_sequence<NUM_BUCKETS>{ }) } { }
+
+    // other is left empty
+    RadixHeap(RadixHeap &&other) noexcept
+    : buckets_{ std::move(other.buckets_) },
+      size_{ std::exchange(other.size_, 0) },
+      last_{ std::exchange(other.last_, 0) } { }
+
+    // other is left empty
+    RadixHeap& operator=(RadixHeap &&other)
+    noexcept(std::is_nothrow_move_assignable_v<BucketArrayT>) {
+        if (this != &other) {
+            buckets_ = std::move(other.buckets_);
+            size_ = std::exchange(other.size_, 0);
+            last_ = std::exchange(other.last_, 0);
+
+            // allocators that don't propagate move element by element
+            for (BucketT &bucket : other.buckets_) {
+                bucket.clear();
+            }
+        }
+
+        return *this;
+    }
+
+    allocator_type get_allocator() const {
+        return buckets_[0].get_allocator();
+    }
+
+    // the element with the smallest key; ties come out in no particular
+    // order. the value may be changed or moved from, but not the key. if
+    // the last pop emptied the lowest bucket, this scans the next one
+    reference top() {
+        assert(not empty());
+
+        return *min_of(first_bucket());
+    }
+
+    const_reference top() const {
+        assert(not empty());
+
+        return *min_of(first_bucket());
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    // the last key popped, which is the smallest that may still be pushed
+    key_type last_key() const noexcept {
+        return last_;
+    }
+
+    // buckets keep their capacity, and keys may start over from zero
+    void clear() noexcept {
+        for (BucketT &bucket : buckets_) {
+            bucket.clear();
+        }
+
+        size_ = 0;
+        last_ = 0;
+    }
+
+    void push(const value_type &value) {
+        emplace(value.first, value.second);
+    }
+
+    void push(value_type &&value) {
+        emplace(value.first, std::move(value.second));
+    }
+
+    // constructs the value from args
+    template <typename ...Args>
+    void emplace(const key_type key, Args &&...args) {
+        assert(key >= last_);
+
+        buckets_[bucket_of(key)].emplace_back(
+            std::piecewise_construct, std::forward_as_tuple(key),
+            std::forward_as_tuple(std::forward<Args>(args)...)
+        );
+        ++size_;
+    }
+
+    // refilling waits until here rather than following the previous pop,
+    // since it raises the last key to the new minimum and anything between
+    // the two may still be pushed until then
+    void pop() {
+        assert(not empty());
+
+        if (buckets_[0].empty()) {
+            refill();
+        }
+
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+    void swap(RadixHeap &other) noexcept {
+        using std::swap;
+
+        swap(buckets_, other.buckets_);
+        swap(size_, other.size_);
+        swap(last_, other.last_);
+    }
+
+private:
+    template <std::size_t ...Is>
+    static BucketArrayT make_buckets(const allocator_type &allocator,
+                                     std::index_sequence<Is...>) {
+        return BucketArrayT{
+            { (static_cast<void>(Is), BucketT(allocator))... }
+        };
+    }
+
+    // assumes the heap isn't empty
+    BucketT& first_bucket() {
+        return const_cast<BucketT&>(std::as_const(*this).first_bucket());
+    }
+
+    const BucketT& first_bucket() const {
+        std::size_t index = 0;
+
+        while (buckets_[index].empty()) {
+            ++index;
+        }
+
+        return buckets_[index];
+    }
+
+    // the last element with the smallest key, since that's the one refill
+    // leaves at the back of bucket 0. every key in bucket 0 is the smallest
+    template <typename Bucket>
+    auto min_of(Bucket &bucket) const {
+        if (&bucket == &buckets_[0]) {
+            return bucket.end() - 1;
+        }
+
+        auto min = bucket.begin();
+
+        for (auto iter = bucket.begin(); iter != bucket.end(); ++iter) {
+            if (iter->first <= min->first) {
+                min = iter;
+            }
+        }
+
+        return min;
+    }
+
+    // makes the minimum the last key popped, which sends every element of
+    // its bucket to a lower one, since they all agree with it above the
+    // bucket's bit
+    void refill() {
+        BucketT &source = first_bucket();
+        last_ = min_of(source)->first;
+
+        for (value_type &element : source) {
+            buckets_[bucket_of(element.first)].push_back(std::move(element));
+        }
+
+        source.clear();
+    }
+
+    size_type bucket_of(const key_type key) const noexcept {
+        return detail::bit_width(static_cast<std::uint64_t>(key ^ last_));
+    }
+
+    BucketArrayT buckets_;
+    size_type size_ = 0;
+    key_type last_ = 0;
+};
+
+template <typename Key, typename Value, typename Allocator>
+void swap(RadixHeap<Key, Value, Allocator> &lhs,
+          RadixHeap<Key, Value, Allocator> &rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // namespace gregjm
+
+#endif
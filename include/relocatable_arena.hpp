@@ -0,0 +1,434 @@
+#ifndef GREGJM_RELOCATABLE_ARENA_HPP
+#define GREGJM_RELOCATABLE_ARENA_HPP
+
+#if !defined(_WIN32)
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "address_range.hpp" // gregjm::in_address_range
+#include "arena_stack.hpp" // gregjm::detail::ArenaStack
+#include "virtual_memory.hpp" // gregjm::map_memory, gregjm::release_memory,
+                              // gregjm::round_to_pages, gregjm::page_size,
+                              // gregjm::write_all
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::unique, std::lower_bound, std::upper_bound
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uint64_t, std::uintptr_t
+#include <cstring> // std::memcpy
+#include <mutex> // std::scoped_lock
+#include <utility> // std::exchange
+#include <vector> // std::vector
+
+#include <fcntl.h> // open, O_RDONLY, O_WRONLY, O_CREAT, O_TRUNC, O_CLOEXEC
+#include <sys/mman.h> // mmap, munmap, mprotect
+#include <sys/stat.h> // fstat
+#include <unistd.h> // pread, ftruncate, close
+
+namespace gregjm {
+namespace detail {
+
+// the first page of a saved arena. the arena's bytes follow on the next page
+// and the sorted offsets of its pointer slots follow those
+struct RelocatableArenaHeader {
+    static constexpr std::uint64_t MAGIC = 0x414e4552414d4a47; // "GJMARENA"
+
+    std::uint64_t magic;
+    std::uint64_t base; // where the arena was when it was saved
+    std::uint64_t size;
+    std::uint64_t root; // offset of the root object
+    std::uint64_t data_offset;
+    std::uint64_t relocations_offset;
+    std::uint64_t num_relocations;
+};
+
+} // namespace detail
+
+// a saved arena mapped back into memory. the data is mapped where the arena
+// was when it was saved if that range is free, in which case no pointer
+// needs fixing up; otherwise every recorded pointer slot is adjusted in one
+// pass. the data is read-only, so pages with no fixed up pointers in them
+// stay shared with the page cache
+class MappedArena {
+    using HeaderT = detail::RelocatableArenaHeader;
+
+public:
+    MappedArena() noexcept = default;
+
+    MappedArena(MappedArena &&other) noexcept
+    : mapping_{ std::exchange(other.mapping_, nullptr) },
+      mapping_size_{ std::exchange(other.mapping_size_, 0) },
+      memory_{ std::exchange(other.memory_, nullptr) },
+      size_{ std::exchange(other.size_, 0) },
+      root_{ std::exchange(other.root_, 0) } { }
+
+    MappedArena& operator=(MappedArena &&other) noexcept {
+        if (this != &other) {
+            release();
+
+            mapping_ = std::exchange(other.mapping_, nullptr);
+            mapping_size_ = std::exchange(other.mapping_size_, 0);
+            memory_ = std::exchange(other.memory_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            root_ = std::exchange(other.root_, 0);
+        }
+
+        return *this;
+    }
+
+    ~MappedArena() {
+        release();
+    }
+
+    // maps an arena written by RelocatableArena::save. the result is empty
+    // if the file can't be read or isn't a saved arena
+    static MappedArena load(const char *const path) {
+        MappedArena arena;
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return arena;
+        }
+
+        HeaderT header;
+        struct stat status;
+
+        if (pread(fd, &header, sizeof(header), 0)
+                != static_cast<ssize_t>(sizeof(header))
+            or fstat(fd, &status) != 0 or not is_valid(header, status)) {
+            close(fd);
+
+            return arena;
+        }
+
+        // ask for the data to land where it was saved from
+        const auto hint = reinterpret_cast<void*>(
+            static_cast<std::uintptr_t>(header.base - header.data_offset)
+        );
+        const auto size = static_cast<std::size_t>(status.st_size);
+
+        // populating a writable private mapping would copy every page, so
+        // it's only made writable while pointers are fixed up
+        void *const mapping = mmap(hint, size, PROT_READ,
+                                   MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+
+        if (mapping == MAP_FAILED) {
+            return arena;
+        }
+
+        arena.mapping_ = mapping;
+        arena.mapping_size_ = size;
+        arena.memory_ = static_cast<std::uint8_t*>(mapping)
+                        + header.data_offset;
+        arena.size_ = static_cast<std::size_t>(header.size);
+        arena.root_ = static_cast<std::size_t>(header.root);
+
+        if (not arena.relocate(header)) {
+            arena.release();
+        }
+
+        return arena;
+    }
+
+    MemoryBlock memory() const noexcept {
+        return MemoryBlock{ memory_, size_ };
+    }
+
+    // the object passed to RelocatableArena::set_root
+    template <typename T>
+    const T* root() const noexcept {
+        return reinterpret_cast<const T*>(memory_ + root_);
+    }
+
+    explicit operator bool() const noexcept {
+        return mapping_ != nullptr;
+    }
+
+private:
+    static bool is_valid(const HeaderT &header,
+                         const struct stat &status) noexcept {
+        const auto file_size = static_cast<std::uint64_t>(status.st_size);
+
+        return header.magic == HeaderT::MAGIC
+               and header.data_offset % page_size() == 0
+               and header.data_offset <= file_size
+               and header.size <= file_size - header.data_offset
+               and header.root <= header.size
+               and header.relocations_offset <= file_size
+               and header.relocations_offset % sizeof(std::uint64_t) == 0
+               and header.num_relocations
+                   <= (file_size - header.relocations_offset)
+                      / sizeof(std::uint64_t);
+    }
+
+    // returns false if the data couldn't be made writable
+    bool relocate(const HeaderT &header) noexcept {
+        const std::uintptr_t delta = reinterpret_cast<std::uintptr_t>(memory_)
+                                     - static_cast<std::uintptr_t>(header.base);
+
+        if (delta == 0) {
+            return true;
+        }
+
+        if (mprotect(mapping_, mapping_size_, PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+
+        const auto *const table = reinterpret_cast<const std::uint64_t*>(
+            static_cast<const std::uint8_t*>(mapping_)
+            + header.relocations_offset
+        );
+
+        for (std::uint64_t i = 0; i < header.num_relocations; ++i) {
+            const std::uint64_t offset = table[i];
+
+            // a corrupt entry can't be allowed to write outside the data
+            if (size_ < sizeof(std::uintptr_t)
+                or offset > size_ - sizeof(std::uintptr_t)) {
+                continue;
+            }
+
+            std::uintptr_t pointer;
+            std::memcpy(&pointer, memory_ + offset, sizeof(pointer));
+            pointer += delta;
+            std::memcpy(memory_ + offset, &pointer, sizeof(pointer));
+        }
+
+        return mprotect(mapping_, mapping_size_, PROT_READ) == 0;
+    }
+
+    void release() noexcept {
+        if (mapping_) {
+            munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+        }
+    }
+
+    void *mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+    std::uint8_t *memory_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t root_ = 0;
+};
+
+// a stack-style arena that can be saved to a file and mapped back in, by
+// this process or another, with MappedArena::load. pointers stored in the
+// arena that point into it must be recorded with store_pointer or
+// register_pointer so they can be fixed up if the arena lands somewhere
+// else; offsets and OffsetPtrs need no fixing up and needn't be recorded
+template <typename Mutex = DummyMutex>
+class RelocatableArena final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+    using HeaderT = detail::RelocatableArenaHeader;
+
+public:
+    // capacity is rounded up to a multiple of the page size
+    explicit RelocatableArena(const std::size_t capacity)
+    : stack_{ static_cast<std::uint8_t*>(map_memory(round_to_pages(capacity))),
+              round_to_pages(capacity) } { }
+
+    RelocatableArena(const RelocatableArena &other) = delete;
+
+    RelocatableArena& operator=(const RelocatableArena &other) = delete;
+
+    virtual ~RelocatableArena() {
+        release_memory(stack_.memory(), stack_.capacity());
+    }
+
+    // stores pointer in slot and records slot, which must be in the arena
+    template <typename T, typename U>
+    void store_pointer(T *&slot, U *const pointer) {
+        slot = pointer;
+        register_pointer(slot);
+    }
+
+    // records a slot in the arena that holds a pointer into the arena or
+    // nullptr. slots may be recorded more than once
+    template <typename T>
+    void register_pointer(T *const &slot) {
+        const LockT lock{ mutex_ };
+        const auto *const address =
+            reinterpret_cast<const std::uint8_t*>(&slot);
+        const std::size_t top = stack_.top();
+
+        // the whole slot has to lie below the top
+        if (top < sizeof(slot)
+            or not in_address_range(MemoryBlock{ stack_.memory(),
+                                                 top - sizeof(slot) + 1 },
+                                    address)) {
+            throw NotOwnedException{ };
+        }
+
+        // kept sorted so that the slots above the top can be dropped when
+        // it retreats. slots are usually recorded in address order, which
+        // makes this an append
+        const auto offset =
+            static_cast<std::uint64_t>(address - stack_.memory());
+        relocations_.insert(std::upper_bound(relocations_.begin(),
+                                             relocations_.end(), offset),
+                            offset);
+    }
+
+    // the object that MappedArena::root will return
+    void set_root(const void *const root) {
+        const LockT lock{ mutex_ };
+        const auto *const address = static_cast<const std::uint8_t*>(root);
+
+        if (not in_address_range(MemoryBlock{ stack_.memory(), stack_.top() },
+                                 address)) {
+            throw NotOwnedException{ };
+        }
+
+        root_ = static_cast<std::size_t>(address - stack_.memory());
+    }
+
+    // writes the used part of the arena and its pointer slots to path.
+    // returns false if the file couldn't be written or a recorded slot no
+    // longer lies in the arena or points outside it
+    bool save(const char *const path) {
+        const LockT lock{ mutex_ };
+        const std::uint8_t *const memory = stack_.memory();
+        const std::size_t top = stack_.top();
+
+        relocations_.erase(std::unique(relocations_.begin(),
+                                       relocations_.end()),
+                           relocations_.end());
+
+        // null pointers stay null, so they're left out of the table
+        std::vector<std::uint64_t> table;
+        table.reserve(relocations_.size());
+
+        for (const std::uint64_t offset : relocations_) {
+            if (offset > top or top - offset < sizeof(std::uintptr_t)) {
+                return false;
+            }
+
+            std::uintptr_t pointer;
+            std::memcpy(&pointer, memory + offset, sizeof(pointer));
+
+            if (pointer == 0) {
+                continue;
+            }
+
+            if (pointer - reinterpret_cast<std::uintptr_t>(memory) > top) {
+                return false;
+            }
+
+            table.push_back(offset);
+        }
+
+        const std::size_t page = page_size();
+        HeaderT header{ };
+        header.magic = HeaderT::MAGIC;
+        header.base = reinterpret_cast<std::uintptr_t>(memory);
+        header.size = top;
+        header.root = root_;
+        header.data_offset = page;
+        header.relocations_offset = page + round_to_pages(top);
+        header.num_relocations = table.size();
+
+        const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                            0644);
+
+        if (fd < 0) {
+            return false;
+        }
+
+        const std::size_t table_size = table.size() * sizeof(std::uint64_t);
+
+        // the file is sized up front so the data is all there even if the
+        // table is empty
+        const bool written =
+            ftruncate(fd, static_cast<off_t>(header.relocations_offset
+                                             + table_size)) == 0
+            and write_all(fd, &header, sizeof(header), 0)
+            and write_all(fd, memory, top, header.data_offset)
+            and write_all(fd, table.data(), table_size,
+                          header.relocations_offset);
+
+        return (close(fd) == 0) and written;
+    }
+
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ stack_.memory(), stack_.capacity() };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.allocate(size, alignment);
+    }
+
+    // the top block grows or shrinks in place
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        const MemoryBlock realloc_block =
+            stack_.reallocate(block, size, alignment);
+        drop_relocations();
+
+        return realloc_block;
+    }
+
+    // slots recorded in freed memory below the top are checked again when
+    // the arena is saved
+    void deallocate_impl(const MemoryBlock block) override {
+        const LockT lock{ mutex_ };
+
+        stack_.deallocate(block);
+        drop_relocations();
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        stack_.reset();
+        relocations_.clear();
+    }
+
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.max_size();
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.owns(block);
+    }
+
+    // assumes resources are locked. forgets the slots that don't fit
+    // below the top, which a later allocation may reuse for anything
+    void drop_relocations() noexcept {
+        const std::size_t top = stack_.top();
+
+        if (top < sizeof(std::uintptr_t)) {
+            relocations_.clear();
+
+            return;
+        }
+
+        relocations_.erase(std::upper_bound(relocations_.begin(),
+                                            relocations_.end(),
+                                            top - sizeof(std::uintptr_t)),
+                           relocations_.end());
+    }
+
+    detail::ArenaStack stack_;
+    std::size_t root_ = 0;
+    std::vector<std::uint64_t> relocations_;
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef GREGJM_RING_ALLOCATOR_HPP
+#define GREGJM_RING_ALLOCATOR_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "address_range.hpp" // gregjm::in_address_range
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::max, std::min
+#include <array> // std::array
+#include <atomic> // std::atomic
+#include <cassert> // assert
+#include <cstddef> // std::size_t, std::max_align_t
+#include <cstdint> // std::uint8_t, std::uint32_t, std::uintptr_t
+#include <cstring> // std::memcpy
+#include <mutex> // std::scoped_lock
+#include <new> // placement new
+
+namespace gregjm {
+
+// allocates contiguously from a ring of N bytes and reclaims in FIFO order,
+// for streams whose blocks are freed in about the order they were handed
+// out. every block is preceded by a small record header; deallocating marks
+// the record free with a single store and never takes the lock, so blocks
+// can be freed from any thread and in any order. reclamation is deferred to
+// the allocating side, which advances the tail over free records when it
+// runs out of room, so a block freed early is only reused once every block
+// allocated before it has been freed too
+//
+// with the default DummyMutex, allocate and reallocate must come from a
+// single producer thread and the allocator is lock-free; any other Mutex
+// serializes multiple producers
+template <std::size_t N, typename Mutex = DummyMutex>
+class RingAllocator final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+    static constexpr std::size_t RECORD_ALIGNMENT = alignof(std::max_align_t);
+
+    enum class RecordState : std::uint32_t { Live, Free };
+
+    struct alignas(RECORD_ALIGNMENT) RecordHeader {
+        std::atomic<RecordState> state;
+        std::size_t size; // including this header and any slack
+    };
+
+    static constexpr std::size_t HEADER_SIZE = sizeof(RecordHeader);
+
+    static_assert(N % RECORD_ALIGNMENT == 0,
+                  "N must be a multiple of alignof(std::max_align_t)");
+    static_assert(N >= 2 * HEADER_SIZE, "N is too small to hold a record");
+
+public:
+    RingAllocator() noexcept = default;
+
+    RingAllocator(const RingAllocator &other) = delete;
+
+    RingAllocator& operator=(const RingAllocator &other) = delete;
+
+    virtual ~RingAllocator() = default;
+
+    // every block this allocator hands out lies within this range
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ const_cast<std::uint8_t*>(memory_.data()), N };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return allocate_locked(size, alignment);
+    }
+
+    // the newest block grows in place if there's room after it; others are
+    // copied into a new record
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        if (not owns_impl(block)) {
+            throw NotOwnedException{ };
+        }
+
+        const LockT lock{ mutex_ };
+
+        RecordHeader &header = header_of(block);
+        const std::size_t begin = offset_of(&header);
+        const std::size_t capacity = header.size - HEADER_SIZE;
+
+        if (size <= capacity and is_aligned(block.memory, alignment)) {
+            return MemoryBlock{ block.memory, size };
+        }
+
+        if (is_aligned(block.memory, alignment)
+            and begin + header.size == head_ and size <= N - begin) {
+            const std::size_t extra =
+                round_up(begin + HEADER_SIZE + size, RECORD_ALIGNMENT)
+                - head_;
+
+            if (extra <= free_after_head()
+                or (reclaim(), extra <= free_after_head())) {
+                header.size += extra;
+                head_ += extra;
+                used_ += extra;
+
+                if (head_ == N) {
+                    head_ = 0;
+                }
+
+                return MemoryBlock{ block.memory, size };
+            }
+        }
+
+        const MemoryBlock realloc_block = allocate_locked(size, alignment);
+        std::memcpy(realloc_block.memory, block.memory,
+                    std::min(size, block.size));
+        header_of(block).state.store(RecordState::Free,
+                                     std::memory_order_release);
+
+        return realloc_block;
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        if (not owns_impl(block)) {
+            throw NotOwnedException{ };
+        }
+
+        RecordHeader &header = header_of(block);
+
+        assert(header.state.load(std::memory_order_relaxed)
+               == RecordState::Live);
+
+        header.state.store(RecordState::Free, std::memory_order_release);
+    }
+
+    // not safe to call while blocks are being freed
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        head_ = 0;
+        tail_ = 0;
+        used_ = 0;
+    }
+
+    // the largest block that fits without reclaiming anything
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        std::size_t contiguous = free_after_head();
+
+        if (used_ != 0 and head_ > tail_) {
+            contiguous = std::max(contiguous, tail_);
+        }
+
+        return (contiguous > HEADER_SIZE) ? contiguous - HEADER_SIZE : 0;
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        return in_address_range(address_range(), block.memory);
+    }
+
+    // assumes resources are locked
+    MemoryBlock allocate_locked(const std::size_t size,
+                                const std::size_t alignment) {
+        if (void *const memory = try_allocate(size, alignment)) {
+            return MemoryBlock{ memory, size };
+        }
+
+        reclaim();
+
+        if (void *const memory = try_allocate(size, alignment)) {
+            return MemoryBlock{ memory, size };
+        }
+
+        throw BadAllocationException{ };
+    }
+
+    // assumes resources are locked. places the record at the head or, if it
+    // doesn't fit before the end of the ring, after a padding record that
+    // skips to the start
+    void* try_allocate(const std::size_t size, const std::size_t alignment) {
+        if (used_ == 0) {
+            head_ = 0;
+            tail_ = 0;
+        }
+
+        if (void *const memory = place(head_, free_after_head(), size,
+                                       alignment)) {
+            return memory;
+        }
+
+        // the free space at the start of the ring only counts while the head
+        // is past the tail; if they're equal the ring is full
+        if (used_ == 0 or head_ <= tail_) {
+            return nullptr;
+        }
+
+        const std::size_t skipped = N - head_;
+
+        if (not fits(0, tail_, size, alignment)) {
+            return nullptr;
+        }
+
+        if (skipped != 0) {
+            write_record(head_, skipped, RecordState::Free);
+            used_ += skipped;
+        }
+
+        head_ = 0;
+
+        return place(0, tail_, size, alignment);
+    }
+
+    // assumes resources are locked. writes a record for size bytes somewhere
+    // in the available bytes starting at offset and advances the head past
+    // it, preceded by a padding record if alignment calls for one
+    void* place(const std::size_t offset, const std::size_t available,
+                const std::size_t size, const std::size_t alignment) {
+        std::size_t header;
+        std::size_t length;
+
+        if (not layout(offset, size, alignment, header, length)
+            or header - offset + length > available) {
+            return nullptr;
+        }
+
+        if (header != offset) {
+            write_record(offset, header - offset, RecordState::Free);
+        }
+
+        write_record(header, length, RecordState::Live);
+        used_ += header - offset + length;
+        head_ = header + length;
+
+        if (head_ == N) {
+            head_ = 0;
+        }
+
+        return memory_.data() + header + HEADER_SIZE;
+    }
+
+    bool fits(const std::size_t offset, const std::size_t available,
+              const std::size_t size, const std::size_t alignment) const {
+        std::size_t header;
+        std::size_t length;
+
+        return layout(offset, size, alignment, header, length)
+               and header - offset + length <= available;
+    }
+
+    // where a record at offset must put its header so the block after it is
+    // aligned, and how long the record is. false if it can't fit in the ring
+    bool layout(const std::size_t offset, const std::size_t size,
+                const std::size_t alignment, std::size_t &header,
+                std::size_t &length) const noexcept {
+        const std::size_t block_alignment =
+            std::max(alignment, RECORD_ALIGNMENT);
+
+        if (size > N or block_alignment > N) {
+            return false;
+        }
+
+        const auto base = reinterpret_cast<std::uintptr_t>(memory_.data());
+        const std::uintptr_t block =
+            round_up(base + offset + HEADER_SIZE, block_alignment);
+
+        // any gap before the header is a multiple of HEADER_SIZE, so it can
+        // always hold a padding record. empty blocks still get a byte so
+        // their address lies inside the ring
+        header = static_cast<std::size_t>(block - base) - HEADER_SIZE;
+        length = round_up(HEADER_SIZE + std::max(size, std::size_t{ 1 }),
+                          RECORD_ALIGNMENT);
+
+        return header <= N and length <= N - header;
+    }
+
+    // assumes resources are locked. advances the tail over every free record
+    // at the front of the ring
+    void reclaim() noexcept {
+        while (used_ != 0) {
+            RecordHeader &header = header_at(tail_);
+
+            if (header.state.load(std::memory_order_acquire)
+                != RecordState::Free) {
+                break;
+            }
+
+            tail_ += header.size;
+            used_ -= header.size;
+
+            if (tail_ == N) {
+                tail_ = 0;
+            }
+        }
+
+        if (used_ == 0) {
+            head_ = 0;
+            tail_ = 0;
+        }
+    }
+
+    // assumes resources are locked
+    std::size_t free_after_head() const noexcept {
+        if (used_ == 0) {
+            return N - head_;
+        }
+
+        if (used_ == N) {
+            return 0;
+        }
+
+        return (head_ < tail_) ? tail_ - head_ : N - head_;
+    }
+
+    void write_record(const std::size_t offset, const std::size_t size,
+                      const RecordState state) noexcept {
+        new (memory_.data() + offset) RecordHeader{ { state }, size };
+    }
+
+    RecordHeader& header_at(const std::size_t offset) noexcept {
+        return *reinterpret_cast<RecordHeader*>(memory_.data() + offset);
+    }
+
+    RecordHeader& header_of(const MemoryBlock block) noexcept {
+        return *reinterpret_cast<RecordHeader*>(
+            static_cast<std::uint8_t*>(block.memory) - HEADER_SIZE
+        );
+    }
+
+    std::size_t offset_of(const RecordHeader *const header) const noexcept {
+        return static_cast<std::size_t>(
+            reinterpret_cast<const std::uint8_t*>(header) - memory_.data()
+        );
+    }
+
+    static bool is_aligned(const void *const memory,
+                           const std::size_t alignment) noexcept {
+        return alignment == 0
+               or (reinterpret_cast<std::uintptr_t>(memory)
+                   & (alignment - 1)) == 0;
+    }
+
+    // multiple must be a power of two
+    template <typename T>
+    static T round_up(const T value, const std::size_t multiple) noexcept {
+        assert((multiple & (multiple - 1)) == 0);
+
+        return (value + multiple - 1) & ~static_cast<T>(multiple - 1);
+    }
+
+    alignas(64) std::array<std::uint8_t, N> memory_;
+    mutable Mutex mutex_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+    std::size_t used_ = 0;
+};
+
+} // namespace gregjm
+
+#endif
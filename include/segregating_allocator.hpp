@@ -1,16 +1,25 @@
 #ifndef GREGJM_SEGREGATING_ALLOCATOR_HPP
 #define GREGJM_SEGREGATING_ALLOCATOR_HPP
 
-#include "polymorphic_allocator.hpp"
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock
+#include "address_range.hpp" // gregjm::has_address_range_v,
+                             // gregjm::in_address_range
 
 #include <cstddef> // std::size_t
 #include <cstring> // std::memcpy
+#include <algorithm> // std::max, std::min
+#include <tuple> // std::tuple
 #include <type_traits> // std::is_nothrow_constructible_v,
                        // std::is_constructible_v, std::enable_if_t
-#include <utility> // std::pair
+#include <utility> // std::pair, std::move, std::piecewise_construct
 
 namespace gregjm {
 
+// blocks of at most N bytes come from Little, everything else from Big.
+// if Little has an address_range(), blocks are routed back by their pointer
+// instead of their size, so a block's size needn't match the size it was
+// allocated with
 template <std::size_t N, typename Little, typename Big>
 class SegregatingAllocator final : public PolymorphicAllocator {
     using PairT = std::pair<Little, Big>;
@@ -23,7 +32,7 @@ public:
     SegregatingAllocator(Little little, Big big)
         noexcept(
             std::is_nothrow_constructible_v<PairT, Little&&, Big&&>
-        ) : allocs_{ std::move(primary), std::move(secondary) }
+        ) : allocs_{ std::move(little), std::move(big) }
     { }
 
     template <typename ...LittleArgs, typename ...BigArgs,
@@ -56,7 +65,7 @@ private:
 
     MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
                                 const std::size_t alignment) override {
-        if (block.size <= N) {
+        if (from_little(block)) {
             return reallocate_from_little(block, size, alignment);
         }
         
@@ -64,7 +73,7 @@ private:
     }
 
     void deallocate_impl(const MemoryBlock block) override {
-        if (block.size <= N) {
+        if (from_little(block)) {
             little().deallocate(block);
         } else {
             big().deallocate(block);
@@ -82,21 +91,29 @@ private:
     }
 
     bool owns_impl(const MemoryBlock block) const override {
-        if (block.size <= N) {
+        if (from_little(block)) {
             return little().owns(block);
         }
 
         return big().owns(block);
     }
 
+    bool from_little(const MemoryBlock block) const noexcept {
+        if constexpr (has_address_range_v<Little>) {
+            return in_address_range(little().address_range(), block.memory);
+        } else {
+            return block.size <= N;
+        }
+    }
+
     MemoryBlock reallocate_from_little(const MemoryBlock block,
                                        const std::size_t size,
                                        const std::size_t alignment) {
         if (size > N) {
             const MemoryBlock new_block = big().allocate(size, alignment);
 
-            // we know that block.size <= N, so block.size < size
-            std::memcpy(new_block.memory, block.memory, block.size);
+            std::memcpy(new_block.memory, block.memory,
+                        std::min(block.size, size));
 
             little().deallocate(block);
 
@@ -112,10 +129,10 @@ private:
         if (size <= N) {
             const MemoryBlock new_block = little().allocate(size, alignment);
 
-            // we know that block.size > N, so size < block.size
-            std::memcpy(new_block.memory, block.memory, size);
+            std::memcpy(new_block.memory, block.memory,
+                        std::min(block.size, size));
 
-            little().deallocate(block);
+            big().deallocate(block);
 
             return new_block;
         }
@@ -0,0 +1,353 @@
+#ifndef GREGJM_SNAPSHOT_ARENA_HPP
+#define GREGJM_SNAPSHOT_ARENA_HPP
+
+#if defined(__linux__)
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException
+#include "arena_stack.hpp" // gregjm::detail::ArenaStack
+#include "virtual_memory.hpp" // gregjm::page_size, gregjm::round_to_pages,
+                              // gregjm::create_shared_memory,
+                              // gregjm::write_all
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::min, std::max
+#include <atomic> // std::atomic
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uint64_t, std::uintptr_t
+#include <cstring> // std::memcpy
+#include <mutex> // std::scoped_lock
+#include <utility> // std::exchange
+
+#include <fcntl.h> // open, O_RDONLY, O_CLOEXEC
+#include <sys/mman.h> // mmap, munmap, mprotect, madvise
+#include <unistd.h> // pread, close
+
+namespace gregjm {
+
+// a frozen, read-only copy of a SnapshotArena's used memory. pointers into
+// the arena can be translated into the snapshot, but pointers stored in the
+// arena still point into the arena, so structures meant to be read from a
+// snapshot should link themselves with offsets or OffsetPtr. must not
+// outlive the arena it was taken from
+class ArenaSnapshot {
+public:
+    ArenaSnapshot() noexcept = default;
+
+    ArenaSnapshot(ArenaSnapshot &&other) noexcept
+    : memory_{ std::exchange(other.memory_, nullptr) },
+      size_{ std::exchange(other.size_, 0) },
+      arena_{ std::exchange(other.arena_, nullptr) },
+      live_{ std::exchange(other.live_, nullptr) } { }
+
+    ArenaSnapshot& operator=(ArenaSnapshot &&other) noexcept {
+        if (this != &other) {
+            release();
+
+            memory_ = std::exchange(other.memory_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            arena_ = std::exchange(other.arena_, nullptr);
+            live_ = std::exchange(other.live_, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~ArenaSnapshot() {
+        release();
+    }
+
+    // the snapshot's memory, which starts where the arena's did
+    MemoryBlock memory() const noexcept {
+        return MemoryBlock{ memory_, size_ };
+    }
+
+    // where something at pointer in the arena is in the snapshot
+    template <typename T>
+    const T* translate(const T *const pointer) const noexcept {
+        const auto offset = reinterpret_cast<std::uintptr_t>(pointer)
+                            - reinterpret_cast<std::uintptr_t>(arena_);
+
+        assert(offset < size_);
+
+        return reinterpret_cast<const T*>(
+            static_cast<const std::uint8_t*>(memory_) + offset
+        );
+    }
+
+    explicit operator bool() const noexcept {
+        return memory_ != nullptr;
+    }
+
+private:
+    template <typename Mutex>
+    friend class SnapshotArena;
+
+    ArenaSnapshot(void *const memory, const std::size_t size,
+                  const void *const arena,
+                  std::atomic<std::size_t> &live) noexcept
+    : memory_{ memory }, size_{ size }, arena_{ arena }, live_{ &live } {
+        live_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+        if (memory_) {
+            munmap(memory_, size_);
+            live_->fetch_sub(1, std::memory_order_release);
+            memory_ = nullptr;
+        }
+    }
+
+    void *memory_ = nullptr;
+    std::size_t size_ = 0;
+    const void *arena_ = nullptr;
+    std::atomic<std::size_t> *live_ = nullptr;
+};
+
+// a stack-style arena over a MAP_PRIVATE view of a memfd. the file holds the
+// arena as of the last compaction and every page written since is a private
+// copy-on-write page, which /proc/self/pagemap tells apart from the file's
+// pages. a snapshot maps the file privately again and copies in just those
+// pages, so it costs time proportional to the pages touched since the last
+// compact(), and the writer carries on in the arena while readers use it
+//
+// compact() writes the touched pages back to the file and drops the private
+// copies; it does nothing while snapshots are alive, since they read their
+// untouched pages from the file. snapshot() and compact() must not run
+// concurrently with writes to the arena
+template <typename Mutex = DummyMutex>
+class SnapshotArena final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+    static constexpr std::uint64_t PAGE_PRESENT = std::uint64_t{ 1 } << 63;
+    static constexpr std::uint64_t PAGE_SWAPPED = std::uint64_t{ 1 } << 62;
+    static constexpr std::uint64_t PAGE_FILE = std::uint64_t{ 1 } << 61;
+
+public:
+    // capacity is rounded up to a multiple of the page size
+    explicit SnapshotArena(const std::size_t capacity)
+    : capacity_{ round_to_pages(capacity) },
+      fd_{ create_shared_memory(capacity_) } {
+        void *const memory = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE, fd_, 0);
+
+        if (memory == MAP_FAILED) {
+            close(fd_);
+
+            throw BadAllocationException{ };
+        }
+
+        stack_ = detail::ArenaStack{ static_cast<std::uint8_t*>(memory),
+                                     capacity_ };
+
+        // without it every page up to the high water mark counts as touched
+        pagemap_fd_ = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    }
+
+    SnapshotArena(const SnapshotArena &other) = delete;
+
+    SnapshotArena& operator=(const SnapshotArena &other) = delete;
+
+    virtual ~SnapshotArena() {
+        assert(live_.load(std::memory_order_acquire) == 0);
+
+        munmap(stack_.memory(), capacity_);
+        close(fd_);
+
+        if (pagemap_fd_ >= 0) {
+            close(pagemap_fd_);
+        }
+    }
+
+    // a read-only copy of everything allocated so far
+    ArenaSnapshot snapshot() {
+        const LockT lock{ mutex_ };
+
+        const std::size_t size = std::max(round_to_pages(stack_.top()),
+                                          page_size());
+        void *const view = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd_, 0);
+
+        if (view == MAP_FAILED) {
+            throw BadAllocationException{ };
+        }
+
+        auto *const copy = static_cast<std::uint8_t*>(view);
+
+        for_each_touched_run(std::min(size, high_water_),
+                             [this, copy](const std::size_t offset,
+                                          const std::size_t length) {
+            std::memcpy(copy + offset, stack_.memory() + offset, length);
+        });
+
+        mprotect(view, size, PROT_READ);
+
+        return ArenaSnapshot{ view, size, stack_.memory(), live_ };
+    }
+
+    // folds touched pages back into the file so that later snapshots don't
+    // have to copy them. returns false without doing anything if any
+    // snapshots are alive
+    bool compact() {
+        const LockT lock{ mutex_ };
+
+        if (live_.load(std::memory_order_acquire) != 0) {
+            return false;
+        }
+
+        const std::size_t used = round_to_pages(stack_.top());
+        bool written = true;
+
+        for_each_touched_run(high_water_,
+                             [this, used, &written](const std::size_t offset,
+                                                    const std::size_t length) {
+            const std::size_t end = std::min(offset + length, used);
+
+            if (offset < end) {
+                written = written
+                          and write_all(fd_, stack_.memory() + offset,
+                                        end - offset, offset);
+            }
+        });
+
+        // if a write failed, the private pages are the only good copy
+        if (not written) {
+            return false;
+        }
+
+        madvise(stack_.memory(), high_water_, MADV_DONTNEED);
+        high_water_ = used;
+
+        return true;
+    }
+
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ stack_.memory(), capacity_ };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.allocate(size, alignment, track_high_water());
+    }
+
+    // the top block grows or shrinks in place
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.reallocate(block, size, alignment, track_high_water());
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        const LockT lock{ mutex_ };
+
+        stack_.deallocate(block);
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        stack_.reset();
+    }
+
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.max_size();
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.owns(block);
+    }
+
+    // pages above the high water mark have never been written since the
+    // last compaction
+    auto track_high_water() noexcept {
+        return [this](const std::size_t top) {
+            high_water_ = std::max(high_water_, round_to_pages(top));
+        };
+    }
+
+    // calls f(offset, length) for each run of consecutive pages in the
+    // first size bytes that the arena has a private copy of
+    template <typename F>
+    void for_each_touched_run(const std::size_t size, F &&f) const {
+        const std::size_t page = page_size();
+        const std::size_t num_pages = size / page;
+
+        if (pagemap_fd_ < 0) {
+            if (num_pages != 0) {
+                f(std::size_t{ 0 }, num_pages * page);
+            }
+
+            return;
+        }
+
+        constexpr std::size_t BATCH = 512;
+        std::uint64_t entries[BATCH];
+        const std::size_t first_page =
+            reinterpret_cast<std::uintptr_t>(stack_.memory()) / page;
+        std::size_t run_begin = 0;
+        std::size_t run_length = 0;
+
+        for (std::size_t i = 0; i < num_pages; i += BATCH) {
+            const std::size_t count = std::min(BATCH, num_pages - i);
+            const auto position =
+                static_cast<off_t>((first_page + i) * sizeof(std::uint64_t));
+            const ssize_t result = pread(pagemap_fd_, entries,
+                                         count * sizeof(std::uint64_t),
+                                         position);
+
+            for (std::size_t j = 0; j < count; ++j) {
+                const bool touched =
+                    result != static_cast<ssize_t>(count
+                                                   * sizeof(std::uint64_t))
+                    or is_private(entries[j]);
+
+                if (touched and run_length != 0
+                    and run_begin + run_length == i + j) {
+                    ++run_length;
+                } else if (touched) {
+                    if (run_length != 0) {
+                        f(run_begin * page, run_length * page);
+                    }
+
+                    run_begin = i + j;
+                    run_length = 1;
+                }
+            }
+        }
+
+        if (run_length != 0) {
+            f(run_begin * page, run_length * page);
+        }
+    }
+
+    // a copy-on-write copy is anonymous memory, resident or swapped out,
+    // rather than a page of the file
+    static bool is_private(const std::uint64_t entry) noexcept {
+        return (entry & PAGE_SWAPPED)
+               or ((entry & PAGE_PRESENT) and not (entry & PAGE_FILE));
+    }
+
+    std::size_t capacity_;
+    int fd_;
+    int pagemap_fd_ = -1;
+    detail::ArenaStack stack_;
+    std::size_t high_water_ = 0;
+    std::atomic<std::size_t> live_{ 0 };
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
+
+#endif
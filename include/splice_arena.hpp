@@ -0,0 +1,241 @@
+#ifndef GREGJM_SPLICE_ARENA_HPP
+#define GREGJM_SPLICE_ARENA_HPP
+
+#if defined(__linux__)
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException,
+                                     // gregjm::NotOwnedException
+#include "arena_stack.hpp" // gregjm::detail::ArenaStack
+#include "virtual_memory.hpp" // gregjm::map_memory, gregjm::release_memory,
+                              // gregjm::round_to_pages, gregjm::page_size
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::max
+#include <cassert> // assert
+#include <cerrno> // errno, EINTR
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
+#include <cstring> // std::memcpy, std::memset
+#include <mutex> // std::scoped_lock
+
+#include <fcntl.h> // vmsplice, splice, fcntl, SPLICE_F_GIFT,
+                   // SPLICE_F_MOVE, SPLICE_F_NONBLOCK, O_NONBLOCK
+#include <sys/mman.h> // mmap, mremap, munmap
+#include <sys/uio.h> // iovec
+
+namespace gregjm {
+namespace detail {
+
+// splice and vmsplice wait on a full or empty pipe even if it was opened
+// with O_NONBLOCK, unless they're passed SPLICE_F_NONBLOCK
+inline unsigned nonblocking_flag(const int fd) noexcept {
+    const int status = fcntl(fd, F_GETFL);
+
+    return (status != -1 and (status & O_NONBLOCK)) ? SPLICE_F_NONBLOCK : 0;
+}
+
+} // namespace detail
+
+// moves up to count bytes from a pipe into fd, which may be a socket or a
+// file, without copying them through user space. returns how many bytes
+// were moved before the pipe ran dry or splice failed
+inline std::size_t splice_to(const int pipe_fd, const int fd,
+                             const std::size_t count) noexcept {
+    const unsigned flags = SPLICE_F_MOVE | detail::nonblocking_flag(pipe_fd)
+                           | detail::nonblocking_flag(fd);
+    std::size_t moved = 0;
+
+    while (moved < count) {
+        const ssize_t result = splice(pipe_fd, nullptr, fd, nullptr,
+                                      count - moved, flags);
+
+        if (result < 0 and errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            break;
+        }
+
+        moved += static_cast<std::size_t>(result);
+    }
+
+    return moved;
+}
+
+// a stack-style arena that hands out whole pages, so that a finished block
+// can be given to a pipe with export_to instead of being copied into it.
+// vmsplice makes the pipe reference the arena's pages, which would corrupt
+// the output if the arena wrote to them before the reader got to them;
+// export_to maps fresh pages over the exported range, leaving the old ones
+// to the pipe, so the addresses can be reused as soon as it returns
+template <typename Mutex = DummyMutex>
+class SpliceArena final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+public:
+    // capacity is rounded up to a multiple of the page size
+    explicit SpliceArena(const std::size_t capacity)
+    : stack_{ static_cast<std::uint8_t*>(map_memory(round_to_pages(capacity))),
+              round_to_pages(capacity) } { }
+
+    SpliceArena(const SpliceArena &other) = delete;
+
+    SpliceArena& operator=(const SpliceArena &other) = delete;
+
+    virtual ~SpliceArena() {
+        release_memory(stack_.memory(), stack_.capacity());
+    }
+
+    // writes block into pipe_fd with vmsplice, gifting its pages to the
+    // pipe. blocks if the pipe is full unless it's non-blocking. returns how
+    // many bytes were exported; the exported part of block reads as zero
+    // afterwards and the rest is left as it was. the block stays allocated
+    std::size_t export_to(const int pipe_fd, const MemoryBlock block) {
+        if (not owns_impl(block)) {
+            throw NotOwnedException{ };
+        }
+
+        auto *const memory = static_cast<std::uint8_t*>(block.memory);
+        const unsigned flags =
+            SPLICE_F_GIFT | detail::nonblocking_flag(pipe_fd);
+        std::size_t exported = 0;
+
+        assert(reinterpret_cast<std::uintptr_t>(memory) % page_size() == 0);
+
+        while (exported < block.size) {
+            iovec vector{ memory + exported, block.size - exported };
+            const ssize_t result = vmsplice(pipe_fd, &vector, 1, flags);
+
+            if (result < 0 and errno == EINTR) {
+                continue;
+            }
+
+            if (result <= 0) {
+                break;
+            }
+
+            exported += static_cast<std::size_t>(result);
+        }
+
+        replace_pages(memory, exported);
+
+        return exported;
+    }
+
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ stack_.memory(), stack_.capacity() };
+    }
+
+private:
+    // blocks are handed to the stack padded out to whole pages
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        if (alignment > page_size()) {
+            throw BadAllocationException{ };
+        }
+
+        const LockT lock{ mutex_ };
+
+        return MemoryBlock{
+            stack_.allocate(pages_for(size), page_size()).memory, size
+        };
+    }
+
+    // the top block grows or shrinks in place
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        if (alignment > page_size()) {
+            throw BadAllocationException{ };
+        }
+
+        const LockT lock{ mutex_ };
+
+        return MemoryBlock{
+            stack_.reallocate(padded(block), pages_for(size),
+                              page_size()).memory,
+            size
+        };
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        const LockT lock{ mutex_ };
+
+        stack_.deallocate(padded(block));
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        stack_.reset();
+    }
+
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.max_size();
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.owns(block);
+    }
+
+    // the block as the stack sees it
+    static MemoryBlock padded(const MemoryBlock block) noexcept {
+        return MemoryBlock{ block.memory, pages_for(block.size) };
+    }
+
+    // backs the pages holding the first count bytes at memory with new
+    // ones. whole pages become zero pages, faulted in up front since the
+    // arena is about to write to them again; a partly exported last page is
+    // copied to a fresh page that's moved into its place
+    static void replace_pages(std::uint8_t *const memory,
+                              const std::size_t count) {
+        const std::size_t page = page_size();
+        const std::size_t whole = count / page * page;
+
+        if (whole != 0
+            and mmap(memory, whole, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_POPULATE,
+                     -1, 0)
+                == MAP_FAILED) {
+            throw BadAllocationException{ };
+        }
+
+        if (whole == count) {
+            return;
+        }
+
+        std::uint8_t *const last = memory + whole;
+        void *const fresh = map_memory(page);
+        std::memcpy(fresh, last, page);
+
+        if (mremap(fresh, page, page, MREMAP_MAYMOVE | MREMAP_FIXED, last)
+            == MAP_FAILED) {
+            release_memory(fresh, page);
+
+            throw BadAllocationException{ };
+        }
+
+        std::memset(last, 0, count - whole);
+    }
+
+    // every block takes at least one page, so distinct blocks never share
+    // one
+    static std::size_t pages_for(const std::size_t size) noexcept {
+        return round_to_pages(std::max(size, std::size_t{ 1 }));
+    }
+
+    detail::ArenaStack stack_;
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
+
+#endif
@@ -20,6 +20,20 @@ class StackAllocator final : public PolymorphicAllocator {
 public:
     virtual ~StackAllocator() = default;
 
+    // every block this allocator hands out lies within this range
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ const_cast<void*>(begin()), N };
+    }
+
+    // faults in the whole buffer up front by calling prefault(memory, size)
+    // on it, usually with a Prefaulter from virtual_memory.hpp; worth doing
+    // when the allocator lives in freshly mapped memory. must not run
+    // alongside allocations
+    template <typename Prefault>
+    void prefault(Prefault &&prefault) {
+        prefault(begin(), N);
+    }
+
 private:
     using LockT = std::scoped_lock<Mutex>;
 
@@ -44,6 +58,8 @@ private:
 
             if (size < block.size) {
                 pop(block.size - size);
+            } else if (size - block.size > max_size_locked()) {
+                throw BadAllocationException{ };
             } else {
                 push(size - block.size);
             }
@@ -145,7 +161,12 @@ private:
 
     MemoryBlock allocate_locked(const std::size_t size,
                                 const std::size_t alignment) {
-        if (size + aligned_offset(size, alignment) > max_size_locked()) {
+        const auto sp = reinterpret_cast<std::uintptr_t>(stack_pointer_);
+        const auto padding = aligned_offset(static_cast<std::size_t>(sp),
+                                            alignment);
+
+        if (padding > max_size_locked()
+            or size > max_size_locked() - padding) {
             throw BadAllocationException{ };
         }
 
@@ -0,0 +1,267 @@
+#ifndef GREGJM_TIERED_ARENA_HPP
+#define GREGJM_TIERED_ARENA_HPP
+
+#if defined(__linux__)
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException
+#include "arena_stack.hpp" // gregjm::detail::ArenaStack
+#include "virtual_arena.hpp" // gregjm::detail::Reservation
+#include "virtual_memory.hpp" // gregjm::map_memory, gregjm::release_memory,
+                              // gregjm::create_temporary_file,
+                              // gregjm::read_all, gregjm::write_all
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t
+#include <mutex> // std::scoped_lock
+#include <string> // std::string
+#include <utility> // std::move
+
+#include <fcntl.h> // posix_fadvise, POSIX_FADV_DONTNEED
+#include <sys/mman.h> // mmap, mremap, msync, madvise
+#include <unistd.h> // ftruncate, fdatasync, close
+
+namespace gregjm {
+
+// a stack-style arena over reserved address space, like VirtualArena, that
+// can move its memory out to a file while it's rarely used. make_cold()
+// writes the committed pages to an unlinked file, maps the file over them
+// and has the kernel drop them from RAM; the arena keeps working as before,
+// with pages faulted back in from the file as they're touched. make_hot()
+// reads everything back into anonymous memory
+//
+// neither may run while anything else reads or writes the arena's memory
+template <typename Mutex = DummyMutex>
+class TieredArena final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+public:
+    // reserves at least reserve bytes of address space, rounded up to a
+    // whole number of commit chunks. cold pages go to a file in directory,
+    // which should be on a disk rather than in memory
+    explicit TieredArena(const std::size_t reserve,
+                         std::string directory = "/var/tmp")
+    : reservation_{ reserve },
+      stack_{ reservation_.memory(), reservation_.size() },
+      directory_{ std::move(directory) } { }
+
+    TieredArena(const TieredArena &other) = delete;
+
+    TieredArena& operator=(const TieredArena &other) = delete;
+
+    virtual ~TieredArena() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    // moves every committed page to the backing file and drops it from RAM.
+    // pages committed since the last call are written out first; pages
+    // already in the file are written back if they were touched. returns
+    // false, leaving the arena as it was, if the file can't be written
+    bool make_cold() {
+        const LockT lock{ mutex_ };
+
+        if (reservation_.committed() > cold_size_ and not extend_cold()) {
+            return false;
+        }
+
+        if (cold_size_ != 0) {
+            page_out();
+        }
+
+        return true;
+    }
+
+    // reads the file-backed pages back into anonymous memory, so the arena
+    // stops depending on the file
+    void make_hot() {
+        const LockT lock{ mutex_ };
+
+        if (cold_size_ == 0) {
+            return;
+        }
+
+        void *const fresh = map_memory(cold_size_);
+
+        if (not read_all(fd_, fresh, cold_size_, 0)
+            or mremap(fresh, cold_size_, cold_size_,
+                      MREMAP_MAYMOVE | MREMAP_FIXED, reservation_.memory())
+               == MAP_FAILED) {
+            release_memory(fresh, cold_size_);
+
+            throw BadAllocationException{ };
+        }
+
+        close(fd_);
+        fd_ = -1;
+        cold_size_ = 0;
+    }
+
+    // how much of the arena is backed by the file
+    std::size_t cold_size() const {
+        const LockT lock{ mutex_ };
+
+        return cold_size_;
+    }
+
+    std::size_t committed() const {
+        const LockT lock{ mutex_ };
+
+        return reservation_.committed();
+    }
+
+    // decommits every chunk above the top of the stack
+    void trim() {
+        const LockT lock{ mutex_ };
+
+        decommit_from(stack_.top());
+    }
+
+    // every block this allocator hands out lies within this range
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ reservation_.memory(), reservation_.size() };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.allocate(size, alignment, commit());
+    }
+
+    // the top block grows or shrinks in place
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.reallocate(block, size, alignment, commit());
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        const LockT lock{ mutex_ };
+
+        stack_.deallocate(block);
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        decommit_from(0);
+        stack_.reset();
+    }
+
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.max_size();
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.owns(block);
+    }
+
+    // commits pages as the top of the stack advances. pages past the
+    // file-backed part are always anonymous
+    auto commit() noexcept {
+        return [this](const std::size_t top) { reservation_.commit_to(top); };
+    }
+
+    // assumes resources are locked. returns every chunk from the one holding
+    // offset on to the reservation, along with its part of the file
+    void decommit_from(std::size_t offset) {
+        offset = detail::Reservation::round_to_chunks(offset);
+
+        if (offset < cold_size_) {
+            if (mmap(reservation_.memory() + offset, cold_size_ - offset,
+                     PROT_NONE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE,
+                     -1, 0) == MAP_FAILED) {
+                throw BadAllocationException{ };
+            }
+
+            cold_size_ = offset;
+
+            if (cold_size_ == 0) {
+                close(fd_);
+                fd_ = -1;
+            } else {
+                ftruncate(fd_, static_cast<off_t>(cold_size_));
+            }
+        }
+
+        reservation_.decommit_from(offset);
+    }
+
+    // assumes resources are locked. writes the anonymous pages above the
+    // file-backed part to the file and maps them from there. the data is
+    // synced first so the pages are clean and can be dropped at once
+    bool extend_cold() {
+        const bool opened = (fd_ < 0);
+
+        if (opened) {
+            fd_ = create_temporary_file(directory_);
+
+            if (fd_ < 0) {
+                return false;
+            }
+        }
+
+        std::uint8_t *const memory = reservation_.memory();
+        const std::size_t committed = reservation_.committed();
+        const std::size_t length = committed - cold_size_;
+
+        if (ftruncate(fd_, static_cast<off_t>(committed)) != 0
+            or not write_all(fd_, memory + cold_size_, length, cold_size_)
+            or fdatasync(fd_) != 0) {
+            if (opened) {
+                close(fd_);
+                fd_ = -1;
+            } else {
+                ftruncate(fd_, static_cast<off_t>(cold_size_));
+            }
+
+            return false;
+        }
+
+        if (mmap(memory + cold_size_, length, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd_, static_cast<off_t>(cold_size_))
+            == MAP_FAILED) {
+            throw BadAllocationException{ };
+        }
+
+        cold_size_ = committed;
+
+        return true;
+    }
+
+    // assumes resources are locked. dirty pages have to be written back
+    // before the kernel will drop them
+    void page_out() noexcept {
+        msync(reservation_.memory(), cold_size_, MS_SYNC);
+#if defined(MADV_PAGEOUT)
+        madvise(reservation_.memory(), cold_size_, MADV_PAGEOUT);
+#endif
+        // catches whatever is cached but not mapped
+        posix_fadvise(fd_, 0, static_cast<off_t>(cold_size_),
+                      POSIX_FADV_DONTNEED);
+    }
+
+    detail::Reservation reservation_;
+    detail::ArenaStack stack_;
+    std::string directory_;
+    std::size_t cold_size_ = 0;
+    int fd_ = -1;
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
+
+#endif
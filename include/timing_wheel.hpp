@@ -0,0 +1,255 @@
+#ifndef GREGJM_TIMING_WHEEL_HPP
+#define GREGJM_TIMING_WHEEL_HPP
+
+#include <array> // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+#include <functional> // std::invoke
+#include <type_traits> // std::is_invocable_v
+
+namespace gregjm {
+
+// the hook a timer embeds, usually as a base class, to be scheduled on a
+// HierarchicalTimingWheel. the wheel never allocates or frees timers, so
+// they can come from a pool, an arena or anywhere else. a timer has to be
+// cancelled before it's destroyed, and copying one doesn't copy its place
+// in a wheel
+struct TimerNode {
+    TimerNode() noexcept = default;
+
+    TimerNode(const TimerNode&) noexcept { }
+
+    TimerNode& operator=(const TimerNode&) noexcept {
+        return *this;
+    }
+
+    bool is_scheduled() const noexcept {
+        return next != nullptr;
+    }
+
+    // the tick this timer is due on
+    std::uint64_t expiry() const noexcept {
+        return expiry_tick;
+    }
+
+    TimerNode *prev = nullptr;
+    TimerNode *next = nullptr;
+    std::uint64_t expiry_tick = 0;
+};
+
+// timers bucketed by expiry tick in Levels wheels of 2^Bits slots each,
+// where a slot of level k covers 2^(Bits * k) ticks. a timer goes in the
+// highest level where its expiry differs from the current tick, and moves
+// down a level each time the wheel above turns over to its slot, so
+// scheduling, cancelling and each tick are O(1) no matter how many timers
+// there are. timers due past the top level's range wait in its slots and
+// are looked at again each time it comes around
+//
+// the slots are circular lists through the timers themselves, so the
+// wheel can't be copied or moved
+template <std::size_t Bits = 8, std::size_t Levels = 4>
+class HierarchicalTimingWheel final {
+    static_assert(Bits > 0 and Levels > 0 and Bits * Levels <= 64,
+                  "the wheel's range must fit in 64 bits");
+
+    static inline constexpr std::size_t SLOTS = std::size_t{ 1 } << Bits;
+    static inline constexpr std::uint64_t MASK = SLOTS - 1;
+
+public:
+    explicit HierarchicalTimingWheel(const std::uint64_t now = 0) noexcept
+    : now_{ now } {
+        for (auto &level : slots_) {
+            for (TimerNode &slot : level) {
+                slot.prev = &slot;
+                slot.next = &slot;
+            }
+        }
+    }
+
+    HierarchicalTimingWheel(const HierarchicalTimingWheel &other) = delete;
+
+    HierarchicalTimingWheel&
+    operator=(const HierarchicalTimingWheel &other) = delete;
+
+    std::uint64_t now() const noexcept {
+        return now_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // timer fires on the first tick at or after expiry, which is never the
+    // current tick, since it's already been processed
+    void schedule(TimerNode &timer, const std::uint64_t expiry) noexcept {
+        assert(not timer.is_scheduled());
+
+        timer.expiry_tick = (expiry > now_) ? expiry : now_ + 1;
+        link(timer);
+        ++size_;
+    }
+
+    void cancel(TimerNode &timer) noexcept {
+        assert(timer.is_scheduled());
+
+        unlink(timer);
+        --size_;
+    }
+
+    // schedules timer whether or not it already was
+    void reschedule(TimerNode &timer, const std::uint64_t expiry) noexcept {
+        if (timer.is_scheduled()) {
+            cancel(timer);
+        }
+
+        schedule(timer, expiry);
+    }
+
+    // moves the wheel ticks forward, calling on_expiry(timer) with each
+    // TimerNode that comes due, and returns how many did. each tick's
+    // timers are taken out of the wheel as a batch before any of them is
+    // passed on, so on_expiry may schedule or cancel any timer, including
+    // the one it was given and others in the same batch
+    //
+    // if on_expiry throws, the wheel stops at the current tick and the
+    // timers left in its batch stay scheduled, overdue, to fire first on
+    // the next tick
+    template <typename Callback>
+    std::size_t advance(std::uint64_t ticks, Callback &&on_expiry) {
+        static_assert(std::is_invocable_v<Callback&, TimerNode&>,
+                      "must be able to invoke Callback with TimerNode&");
+
+        std::size_t num_expired = 0;
+
+        for (; ticks != 0; --ticks) {
+            // nothing can come due, so skip straight to the end
+            if (size_ == 0) {
+                now_ += ticks;
+
+                break;
+            }
+
+            ++now_;
+            cascade();
+
+            TimerNode batch;
+            splice(slots_[0][now_ & MASK], batch);
+
+            try {
+                while (batch.next != &batch) {
+                    TimerNode &timer = *batch.next;
+
+                    unlink(timer);
+                    --size_;
+                    ++num_expired;
+                    std::invoke(on_expiry, timer);
+                }
+            } catch (...) {
+                // batch is about to go away with the timers still linked
+                // to it
+                splice_front(batch, slots_[0][(now_ + 1) & MASK]);
+
+                throw;
+            }
+        }
+
+        return num_expired;
+    }
+
+private:
+    // whenever the lower levels turn over to zero, the next level's current
+    // slot holds the timers due over the range they now cover
+    void cascade() noexcept {
+        for (std::size_t level = 1; level < Levels; ++level) {
+            const std::size_t shift = Bits * (level - 1);
+
+            if (((now_ >> shift) & MASK) != 0) {
+                return;
+            }
+
+            TimerNode pending;
+            splice(slots_[level][(now_ >> (shift + Bits)) & MASK], pending);
+
+            while (pending.next != &pending) {
+                TimerNode &timer = *pending.next;
+
+                unlink(timer);
+                link(timer);
+            }
+        }
+    }
+
+    // expiry is always past now_, so the slot found here is always ahead of
+    // the level's current one, except for timers out of the top's range
+    void link(TimerNode &timer) noexcept {
+        const std::uint64_t difference = timer.expiry_tick ^ now_;
+        std::size_t level = 0;
+
+        while (level + 1 < Levels
+               and (difference >> (Bits * (level + 1))) != 0) {
+            ++level;
+        }
+
+        TimerNode &slot =
+            slots_[level][(timer.expiry_tick >> (Bits * level)) & MASK];
+
+        timer.prev = slot.prev;
+        timer.next = &slot;
+        slot.prev->next = &timer;
+        slot.prev = &timer;
+    }
+
+    static void unlink(TimerNode &timer) noexcept {
+        timer.prev->next = timer.next;
+        timer.next->prev = timer.prev;
+        timer.prev = nullptr;
+        timer.next = nullptr;
+    }
+
+    // moves every timer in from to the empty list to in O(1)
+    static void splice(TimerNode &from, TimerNode &to) noexcept {
+        if (from.next == &from) {
+            to.prev = &to;
+            to.next = &to;
+
+            return;
+        }
+
+        to.next = from.next;
+        to.prev = from.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.prev = &from;
+        from.next = &from;
+    }
+
+    // moves every timer in from to the front of to in O(1)
+    static void splice_front(TimerNode &from, TimerNode &to) noexcept {
+        if (from.next == &from) {
+            return;
+        }
+
+        TimerNode *const first = from.next;
+        TimerNode *const last = from.prev;
+
+        last->next = to.next;
+        to.next->prev = last;
+        to.next = first;
+        first->prev = &to;
+        from.prev = &from;
+        from.next = &from;
+    }
+
+    std::array<std::array<TimerNode, SLOTS>, Levels> slots_;
+    std::uint64_t now_;
+    std::size_t size_ = 0;
+};
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef GREGJM_VIRTUAL_ARENA_HPP
+#define GREGJM_VIRTUAL_ARENA_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::PolymorphicAllocator,
+                                     // gregjm::MemoryBlock,
+                                     // gregjm::BadAllocationException
+#include "arena_stack.hpp" // gregjm::detail::ArenaStack
+#include "virtual_memory.hpp" // gregjm::reserve_memory,
+                              // gregjm::commit_memory,
+                              // gregjm::decommit_memory,
+                              // gregjm::release_memory,
+                              // gregjm::round_to_pages,
+                              // gregjm::prefault_memory,
+                              // gregjm::PrefaultOptions
+#include "dummy_mutex.hpp" // gregjm::DummyMutex
+
+#include <algorithm> // std::max
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t
+#include <mutex> // std::scoped_lock
+
+namespace gregjm {
+namespace detail {
+
+// address space reserved up front and committed as the arena in it grows.
+// pages are committed 64 KiB at a time to keep system calls rare
+class Reservation {
+public:
+    // reserves at least size bytes, rounded up to a whole number of commit
+    // chunks
+    explicit Reservation(const std::size_t size)
+    : size_{ round_to_chunks(std::max(size, std::size_t{ 1 })) },
+      memory_{ static_cast<std::uint8_t*>(reserve_memory(size_)) } { }
+
+    Reservation(const Reservation &other) = delete;
+
+    Reservation& operator=(const Reservation &other) = delete;
+
+    ~Reservation() {
+        release_memory(memory_, size_);
+    }
+
+    std::uint8_t* memory() const noexcept {
+        return memory_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    std::size_t committed() const noexcept {
+        return committed_;
+    }
+
+    // commits whole chunks up to size, which must be within the reservation
+    void commit_to(const std::size_t size) {
+        if (size > committed_) {
+            const std::size_t target = round_to_chunks(size);
+
+            commit_memory(memory_ + committed_, target - committed_);
+            committed_ = target;
+        }
+    }
+
+    // decommits every chunk from the one holding offset on
+    void decommit_from(const std::size_t offset) {
+        const std::size_t keep = round_to_chunks(offset);
+
+        if (keep < committed_) {
+            decommit_memory(memory_ + keep, committed_ - keep);
+            committed_ = keep;
+        }
+    }
+
+    static std::size_t round_to_chunks(const std::size_t size) noexcept {
+        const std::size_t chunk = commit_chunk();
+
+        return (size + chunk - 1) / chunk * chunk;
+    }
+
+private:
+    static std::size_t commit_chunk() noexcept {
+        return round_to_pages(std::size_t{ 1 } << 16);
+    }
+
+    std::size_t size_;
+    std::uint8_t *memory_;
+    std::size_t committed_ = 0;
+};
+
+} // namespace detail
+
+// a stack-style arena over a range of address space that's reserved up
+// front and committed as the top of the stack advances, so it costs only
+// what's been used but can grow to the whole reservation. reallocating the
+// top block grows or shrinks it where it is, so a buffer that's the only
+// thing in its arena can grow to gigabytes without ever being moved
+//
+// pages stay committed when blocks are freed; trim() gives back the ones
+// above the top and deallocate_all() gives back everything
+template <typename Mutex = DummyMutex>
+class VirtualArena final : public PolymorphicAllocator {
+    using LockT = std::scoped_lock<Mutex>;
+
+public:
+    // reserves at least reserve bytes of address space, rounded up to a
+    // whole number of commit chunks
+    explicit VirtualArena(const std::size_t reserve)
+    : reservation_{ reserve },
+      stack_{ reservation_.memory(), reservation_.size() } { }
+
+    VirtualArena(const VirtualArena &other) = delete;
+
+    VirtualArena& operator=(const VirtualArena &other) = delete;
+
+    virtual ~VirtualArena() = default;
+
+    std::size_t reserved() const noexcept {
+        return reservation_.size();
+    }
+
+    std::size_t committed() const {
+        const LockT lock{ mutex_ };
+
+        return reservation_.committed();
+    }
+
+    // commits and prefaults the first size bytes of the reservation, so the
+    // arena can grow that far without stopping for page faults. must not
+    // run alongside anything that writes to the arena
+    void prefault(const std::size_t size,
+                  const PrefaultOptions options = { }) {
+        const LockT lock{ mutex_ };
+
+        if (size > reservation_.size()) {
+            throw BadAllocationException{ };
+        }
+
+        reservation_.commit_to(size);
+        prefault_memory(reservation_.memory(), size, options);
+    }
+
+    // decommits every chunk above the top of the stack
+    void trim() {
+        const LockT lock{ mutex_ };
+
+        reservation_.decommit_from(stack_.top());
+    }
+
+    // every block this allocator hands out lies within this range
+    MemoryBlock address_range() const noexcept {
+        return MemoryBlock{ reservation_.memory(), reservation_.size() };
+    }
+
+private:
+    MemoryBlock allocate_impl(const std::size_t size,
+                              const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.allocate(size, alignment, commit());
+    }
+
+    // the top block grows or shrinks in place and never moves
+    MemoryBlock reallocate_impl(const MemoryBlock block, const std::size_t size,
+                                const std::size_t alignment) override {
+        const LockT lock{ mutex_ };
+
+        return stack_.reallocate(block, size, alignment, commit());
+    }
+
+    void deallocate_impl(const MemoryBlock block) override {
+        const LockT lock{ mutex_ };
+
+        stack_.deallocate(block);
+    }
+
+    void deallocate_all_impl() override {
+        const LockT lock{ mutex_ };
+
+        reservation_.decommit_from(0);
+        stack_.reset();
+    }
+
+    std::size_t max_size_impl() const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.max_size();
+    }
+
+    bool owns_impl(const MemoryBlock block) const override {
+        const LockT lock{ mutex_ };
+
+        return stack_.owns(block);
+    }
+
+    // commits pages as the top of the stack advances
+    auto commit() noexcept {
+        return [this](const std::size_t top) { reservation_.commit_to(top); };
+    }
+
+    detail::Reservation reservation_;
+    detail::ArenaStack stack_;
+    mutable Mutex mutex_;
+};
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef GREGJM_VIRTUAL_MEMORY_HPP
+#define GREGJM_VIRTUAL_MEMORY_HPP
+
+#include "polymorphic_allocator.hpp" // gregjm::BadAllocationException
+
+#include <algorithm> // std::max
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uintptr_t
+#include <string> // std::string
+#include <system_error> // std::system_error
+#include <thread> // std::thread
+#include <vector> // std::vector
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h> // VirtualAlloc, VirtualFree, GetSystemInfo,
+                     // VirtualLock, VirtualUnlock
+#else
+#include <atomic> // std::atomic
+#include <cstdio> // std::snprintf
+#include <cstdlib> // mkostemp
+#include <fcntl.h> // open, O_RDWR, O_CREAT, O_EXCL, O_CLOEXEC, O_TMPFILE
+#include <sys/mman.h> // mmap, munmap, mprotect, madvise, mlock, munlock,
+                      // memfd_create, shm_open, shm_unlink
+#include <unistd.h> // sysconf, ftruncate, close, getpid, unlink, pread,
+                    // pwrite
+#endif
+
+namespace gregjm {
+
+// thin wrappers over the platform's page mapping calls. sizes and addresses
+// passed to them must be multiples of page_size(); failures to map memory
+// throw BadAllocationException
+
+inline std::size_t page_size() noexcept {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return static_cast<std::size_t>(info.dwPageSize);
+#else
+    static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    return size;
+#endif
+}
+
+inline std::size_t round_to_pages(const std::size_t size) noexcept {
+    const std::size_t page = page_size();
+
+    return (size + page - 1) / page * page;
+}
+
+// reserves address space without backing it; touching it faults
+inline void* reserve_memory(const std::size_t size) {
+#if defined(_WIN32)
+    void *const memory = VirtualAlloc(nullptr, size, MEM_RESERVE,
+                                      PAGE_NOACCESS);
+
+    if (not memory) {
+        throw BadAllocationException{ };
+    }
+#else
+    void *const memory = mmap(nullptr, size, PROT_NONE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                              -1, 0);
+
+    if (memory == MAP_FAILED) {
+        throw BadAllocationException{ };
+    }
+#endif
+
+    return memory;
+}
+
+// makes reserved memory readable and writable; fresh pages read as zero
+inline void commit_memory(void *const memory, const std::size_t size) {
+#if defined(_WIN32)
+    if (not VirtualAlloc(memory, size, MEM_COMMIT, PAGE_READWRITE)) {
+        throw BadAllocationException{ };
+    }
+#else
+    if (mprotect(memory, size, PROT_READ | PROT_WRITE) != 0) {
+        throw BadAllocationException{ };
+    }
+#endif
+}
+
+// gives committed pages back to the OS but keeps the address space reserved
+inline void decommit_memory(void *const memory,
+                            const std::size_t size) noexcept {
+#if defined(_WIN32)
+    VirtualFree(memory, size, MEM_DECOMMIT);
+#else
+    madvise(memory, size, MADV_DONTNEED);
+    mprotect(memory, size, PROT_NONE);
+#endif
+}
+
+// releases an entire reservation made by reserve_memory or map_memory
+inline void release_memory(void *const memory,
+                           [[maybe_unused]] const std::size_t size) noexcept {
+#if defined(_WIN32)
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+// reserves and commits in one step
+inline void* map_memory(const std::size_t size) {
+#if defined(_WIN32)
+    void *const memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT,
+                                      PAGE_READWRITE);
+
+    if (not memory) {
+        throw BadAllocationException{ };
+    }
+#else
+    void *const memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+        throw BadAllocationException{ };
+    }
+#endif
+
+    return memory;
+}
+
+// locks committed pages into RAM so they're never paged out. throws if that
+// would go over the process's limit on locked memory
+inline void lock_memory(void *const memory, const std::size_t size) {
+#if defined(_WIN32)
+    if (not VirtualLock(memory, size)) {
+        throw BadAllocationException{ };
+    }
+#else
+    if (mlock(memory, size) != 0) {
+        throw BadAllocationException{ };
+    }
+#endif
+}
+
+inline void unlock_memory(void *const memory,
+                          const std::size_t size) noexcept {
+#if defined(_WIN32)
+    VirtualUnlock(memory, size);
+#else
+    munlock(memory, size);
+#endif
+}
+
+// how prefault_memory warms up a range
+struct PrefaultOptions {
+    // how many threads share the page faults, counting the calling one
+    std::size_t threads = 1;
+
+    // whether to lock the pages into RAM as well
+    bool lock = false;
+};
+
+namespace detail {
+
+// faults in [first, last) for writing without changing its contents, with
+// MADV_POPULATE_WRITE if the kernel has it and by writing a byte to every
+// page otherwise
+inline void populate_pages(std::uint8_t *const first,
+                           std::uint8_t *const last) noexcept {
+    const std::uintptr_t page = page_size();
+    auto *const base = reinterpret_cast<std::uint8_t*>(
+        reinterpret_cast<std::uintptr_t>(first) & ~(page - 1)
+    );
+
+#if defined(MADV_POPULATE_WRITE)
+    if (madvise(base, static_cast<std::size_t>(last - base),
+                MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+
+    for (std::uint8_t *current = base; current < last; current += page) {
+        volatile std::uint8_t *const byte = (current < first) ? first
+                                                              : current;
+        *byte = *byte;
+    }
+}
+
+} // namespace detail
+
+// faults in every page of a committed range up front, so that the first
+// writes to it don't stop for page faults. nothing else may write to the
+// range while this runs. if threads can't be started, the calling thread
+// does their share
+inline void prefault_memory(void *const memory, const std::size_t size,
+                            const PrefaultOptions options = { }) {
+    if (size == 0) {
+        return;
+    }
+
+    auto *const first = static_cast<std::uint8_t*>(memory);
+    const std::size_t threads = std::max(options.threads, std::size_t{ 1 });
+    const std::size_t share = round_to_pages((size + threads - 1) / threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    std::size_t offset = 0;
+
+    try {
+        for (; workers.size() + 1 < threads and share < size - offset;
+             offset += share) {
+            workers.emplace_back(detail::populate_pages, first + offset,
+                                 first + offset + share);
+        }
+    } catch (const std::system_error&) { }
+
+    detail::populate_pages(first + offset, first + size);
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    if (options.lock) {
+        lock_memory(memory, size);
+    }
+}
+
+// prefault_memory with its options bound, for the allocators that take a
+// prefault callable so as not to depend on this header
+struct Prefaulter {
+    void operator()(void *const memory, const std::size_t size) const {
+        prefault_memory(memory, size, options);
+    }
+
+    PrefaultOptions options;
+};
+
+#if !defined(_WIN32)
+// an unlinked shared memory object of size bytes, returned as a file
+// descriptor that can be mapped more than once
+inline int create_shared_memory(const std::size_t size) {
+#if defined(__linux__)
+    const int fd = memfd_create("gregjm-shared-memory", MFD_CLOEXEC);
+#else
+    static std::atomic<unsigned> counter{ 0 };
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "/gregjm-shared-memory-%ld-%u",
+                  static_cast<long>(getpid()),
+                  counter.fetch_add(1, std::memory_order_relaxed));
+
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd >= 0) {
+        shm_unlink(name);
+    }
+#endif
+
+    if (fd < 0) {
+        throw BadAllocationException{ };
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+
+        throw BadAllocationException{ };
+    }
+
+    return fd;
+}
+
+// an unlinked file in directory opened for reading and writing, or -1. its
+// space goes back to the filesystem once it's closed and unmapped
+inline int create_temporary_file(const std::string &directory) {
+#if defined(O_TMPFILE)
+    const int fd = open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC,
+                        0600);
+
+    if (fd >= 0) {
+        return fd;
+    }
+#endif
+
+    // not every filesystem supports O_TMPFILE
+    std::string path = directory + "/gregjm-XXXXXX";
+    const int named_fd = mkostemp(path.data(), O_CLOEXEC);
+
+    if (named_fd >= 0) {
+        unlink(path.c_str());
+    }
+
+    return named_fd;
+}
+
+// writes size bytes from memory to fd at offset, carrying on after short
+// writes. returns false if a write fails
+inline bool write_all(const int fd, const void *const memory,
+                      std::size_t size, std::size_t offset) noexcept {
+    const auto *bytes = static_cast<const std::uint8_t*>(memory);
+
+    while (size != 0) {
+        const ssize_t result = pwrite(fd, bytes, size,
+                                      static_cast<off_t>(offset));
+
+        if (result <= 0) {
+            return false;
+        }
+
+        bytes += result;
+        size -= static_cast<std::size_t>(result);
+        offset += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+// reads size bytes from fd at offset into memory, carrying on after short
+// reads. returns false if a read fails or the file ends first
+inline bool read_all(const int fd, void *const memory, std::size_t size,
+                     std::size_t offset) noexcept {
+    auto *bytes = static_cast<std::uint8_t*>(memory);
+
+    while (size != 0) {
+        const ssize_t result = pread(fd, bytes, size,
+                                     static_cast<off_t>(offset));
+
+        if (result <= 0) {
+            return false;
+        }
+
+        bytes += result;
+        size -= static_cast<std::size_t>(result);
+        offset += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+#endif
+
+} // namespace gregjm
+
+#endif
@@ -0,0 +1,196 @@
+#include "catch.hpp"
+
+#include "bounded_heap.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("BoundedHeap keeps the best elements", "[BoundedHeap]") {
+    GIVEN("a stream of shuffled ints") {
+        std::vector<int> values(1000);
+
+        for (int i = 0; i < 1000; ++i) {
+            values[i] = (i * 7919) % 1000;
+        }
+
+        THEN("the greatest are kept by default") {
+            gregjm::BoundedHeap<int> heap{ 10 };
+
+            for (const int value : values) {
+                heap.push(value);
+            }
+
+            REQUIRE(heap.full());
+            REQUIRE(heap.size() == 10);
+            REQUIRE(heap.worst() == 990);
+
+            std::vector<int> kept;
+            heap.drain(std::back_inserter(kept));
+
+            REQUIRE(kept == std::vector<int>{ 990, 991, 992, 993, 994, 995,
+                                              996, 997, 998, 999 });
+            REQUIRE(heap.empty());
+        } AND_THEN("std::greater keeps the least") {
+            gregjm::BoundedHeap<int, std::greater<int>> heap{ 3 };
+
+            for (const int value : values) {
+                heap.push(value);
+            }
+
+            std::vector<int> kept;
+            heap.drain(std::back_inserter(kept));
+
+            REQUIRE(kept == std::vector<int>{ 2, 1, 0 });
+        }
+    } GIVEN("a full BoundedHeap") {
+        gregjm::BoundedHeap<std::string> heap{ 2 };
+
+        REQUIRE(heap.push("b"));
+        REQUIRE(heap.push("c"));
+
+        THEN("pushes that don't beat the worst are turned away") {
+            REQUIRE_FALSE(heap.push("a"));
+            REQUIRE_FALSE(heap.push("b"));
+            REQUIRE(heap.worst() == "b");
+        } AND_THEN("pushes that do take its place") {
+            REQUIRE(heap.push("d"));
+            REQUIRE(heap.size() == 2);
+            REQUIRE(heap.worst() == "c");
+            REQUIRE(std::count(heap.begin(), heap.end(), "d") == 1);
+        }
+    } GIVEN("a BoundedHeap with no room") {
+        gregjm::BoundedHeap<int> heap{ 0 };
+
+        THEN("nothing is kept") {
+            REQUIRE_FALSE(heap.push(1));
+            REQUIRE(heap.empty());
+        }
+    }
+}
+
+namespace {
+
+// counts live allocations through a pointer, so a node freed through a
+// dead heap's allocator is a use after free
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(std::ptrdiff_t &count) noexcept
+    : live{ &count } { }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &other) noexcept
+    : live{ other.live } { }
+
+    T* allocate(const std::size_t n) {
+        ++*live;
+
+        return std::allocator<T>{ }.allocate(n);
+    }
+
+    void deallocate(T *const pointer, const std::size_t n) noexcept {
+        --*live;
+        std::allocator<T>{ }.deallocate(pointer, n);
+    }
+
+    std::ptrdiff_t *live;
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T> &lhs,
+                const CountingAllocator<U> &rhs) noexcept {
+    return lhs.live == rhs.live;
+}
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T> &lhs,
+                const CountingAllocator<U> &rhs) noexcept {
+    return lhs.live != rhs.live;
+}
+
+} // namespace
+
+TEST_CASE("BoundedHeap moves and swaps its nodes", "[BoundedHeap]") {
+    using HeapT = gregjm::BoundedHeap<std::string, std::less<std::string>,
+                                      CountingAllocator<std::string>>;
+
+    GIVEN("a BoundedHeap of some trees") {
+        std::ptrdiff_t live = 0;
+        auto source = std::make_unique<HeapT>(
+            8, CountingAllocator<std::string>{ live }
+        );
+
+        for (int i = 0; i < 20; ++i) {
+            source->push(std::to_string(i % 10));
+        }
+
+        THEN("a heap moved from it outlives it") {
+            {
+                HeapT moved{ std::move(*source) };
+                source.reset();
+
+                REQUIRE(moved.size() == 8);
+                REQUIRE(moved.push("9"));
+
+                std::vector<std::string> kept;
+                moved.drain(std::back_inserter(kept));
+
+                REQUIRE(kept == std::vector<std::string>{ "6", "7", "7", "8",
+                                                          "8", "9", "9",
+                                                          "9" });
+            }
+
+            REQUIRE(live == 0);
+        } AND_THEN("a heap swapped with it outlives it") {
+            {
+                HeapT other{ 2, CountingAllocator<std::string>{ live } };
+                other.push("a");
+                other.push("b");
+
+                swap(other, *source);
+                source->push("c");
+                source.reset();
+
+                REQUIRE(other.size() == 8);
+                REQUIRE(other.worst() == "6");
+                REQUIRE(other.push("9"));
+                REQUIRE(other.push("9"));
+                REQUIRE(other.worst() == "7");
+            }
+
+            REQUIRE(live == 0);
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap replace_top", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap of some trees") {
+        gregjm::FibonacciHeap<int> heap;
+
+        for (int i = 0; i < 100; ++i) {
+            heap.push(i);
+        }
+
+        heap.pop(); // consolidates the rest into trees
+
+        THEN("the new element moves down to where it belongs") {
+            const auto replaced = heap.replace_top(50);
+
+            REQUIRE(*replaced == 50);
+            REQUIRE(heap.size() == 99);
+
+            std::vector<int> popped;
+            heap.pop_k(99, std::back_inserter(popped));
+
+            REQUIRE(std::is_sorted(popped.crbegin(), popped.crend()));
+            REQUIRE(std::count(popped.cbegin(), popped.cend(), 50) == 2);
+            REQUIRE(std::count(popped.cbegin(), popped.cend(), 98) == 0);
+        }
+    }
+}
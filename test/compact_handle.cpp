@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include "compact_handle.hpp"
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// lives on the heap, far from the stack, like an arena would
+struct Record {
+    gregjm::OffsetPtr<int> cursor;
+    gregjm::OffsetPtr<Record> next;
+    int values[8];
+};
+
+} // namespace
+
+TEST_CASE("CompactBlock round trips through an arena", "[CompactBlock]") {
+    GIVEN("an arena") {
+        unsigned char buffer[256];
+        const gregjm::MemoryBlock arena{ buffer, sizeof(buffer) };
+
+        THEN("blocks within it are compressed and expanded") {
+            const gregjm::MemoryBlock block{ buffer + 16, 32 };
+            const gregjm::CompactBlock compact = gregjm::compress(arena, block);
+
+            REQUIRE(compact.offset == 16);
+            REQUIRE(compact.size == 32);
+            REQUIRE(gregjm::expand(arena, compact).memory == block.memory);
+            REQUIRE(gregjm::expand(arena, compact).size == block.size);
+
+            const gregjm::MemoryBlock end{ buffer + sizeof(buffer), 0 };
+
+            REQUIRE(gregjm::compress(arena, end).offset == sizeof(buffer));
+        } AND_THEN("blocks outside it are refused") {
+            unsigned char other[16];
+
+            REQUIRE_THROWS_AS(
+                gregjm::compress(arena, gregjm::MemoryBlock{ other, 16 }),
+                gregjm::NotOwnedException
+            );
+            REQUIRE_THROWS_AS(
+                gregjm::compress(arena,
+                                 gregjm::MemoryBlock{ buffer + 250, 16 }),
+                gregjm::NotOwnedException
+            );
+        }
+    }
+}
+
+TEST_CASE("OffsetPtr points relative to itself", "[OffsetPtr]") {
+    GIVEN("records on the heap") {
+        const auto records = std::make_unique<Record[]>(2);
+        Record &first = records[0];
+        Record &second = records[1];
+
+        for (int i = 0; i < 8; ++i) {
+            first.values[i] = i;
+            second.values[i] = 10 + i;
+        }
+
+        first.cursor = first.values;
+        first.next = &second;
+        second.cursor = nullptr;
+
+        THEN("they dereference and compare like raw pointers") {
+            REQUIRE(first.cursor.get() == first.values);
+            REQUIRE(*first.cursor == 0);
+            REQUIRE(first.cursor[3] == 3);
+            REQUIRE(first.next->values[0] == 10);
+            REQUIRE(first.cursor == first.values);
+            REQUIRE(first.values == first.cursor);
+            REQUIRE(first.cursor != second.cursor);
+            REQUIRE_FALSE(second.cursor);
+            REQUIRE(second.cursor == nullptr);
+            REQUIRE(sizeof(first.cursor) == 4);
+        } AND_THEN("arithmetic never makes an OffsetPtr on the stack") {
+            REQUIRE(*(first.cursor + 5) == 5);
+            REQUIRE(*(2 + first.cursor) == 2);
+
+            int *const previous = first.cursor++;
+
+            REQUIRE(previous == first.values);
+            REQUIRE(*first.cursor == 1);
+
+            first.cursor += 4;
+
+            REQUIRE(*first.cursor == 5);
+            REQUIRE(*(first.cursor - 1) == 4);
+            REQUIRE(first.cursor-- == first.values + 5);
+            REQUIRE(*first.cursor == 4);
+
+            second.cursor = first.values;
+
+            REQUIRE(first.cursor - second.cursor == 4);
+            REQUIRE(second.cursor < first.cursor);
+            REQUIRE(second.cursor <= first.cursor);
+            REQUIRE(first.cursor > second.cursor);
+            REQUIRE(first.cursor >= second.cursor);
+        } AND_THEN("raw pointers compare and subtract without an OffsetPtr") {
+            int *const raw = first.values + 6;
+
+            first.cursor += 2;
+
+            REQUIRE(first.cursor - raw == -4);
+            REQUIRE(raw - first.cursor == 4);
+            REQUIRE(first.cursor < raw);
+            REQUIRE(first.cursor <= raw);
+            REQUIRE(raw > first.cursor);
+            REQUIRE(raw >= first.cursor);
+            REQUIRE_FALSE(raw < first.cursor);
+            REQUIRE_FALSE(raw <= first.cursor);
+            REQUIRE_FALSE(first.cursor > raw);
+            REQUIRE_FALSE(first.cursor >= raw);
+        } AND_THEN("copying the memory they're in keeps them valid") {
+            const auto copy = std::make_unique<Record[]>(2);
+            std::memcpy(static_cast<void*>(copy.get()), records.get(),
+                        2 * sizeof(Record));
+
+            REQUIRE(copy[0].cursor.get() == copy[0].values);
+            REQUIRE(copy[0].next.get() == &copy[1]);
+            REQUIRE(copy[0].next->values[3] == 13);
+        }
+    }
+}
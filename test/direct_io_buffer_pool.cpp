@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include "direct_io_buffer_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_CASE("DirectIoBufferPool hands out aligned buffers",
+          "[DirectIoBufferPool]") {
+    GIVEN("a pool of 1000 byte buffers for 512 byte sectors") {
+        gregjm::DirectIoBufferPool<> pool{
+            1000, gregjm::DirectIoAlignment{ 4096, 512 }
+        };
+
+        THEN("buffers are rounded to sectors and aligned to pages") {
+            REQUIRE(pool.buffer_size() == 1024);
+            REQUIRE(pool.alignment() == 4096);
+
+            std::set<void*> buffers;
+
+            for (int i = 0; i < 100; ++i) {
+                const gregjm::MemoryBlock block = pool.allocate(1024, 512);
+                const auto address =
+                    reinterpret_cast<std::uintptr_t>(block.memory);
+
+                REQUIRE(address % 4096 == 0);
+                REQUIRE(pool.owns(block));
+                REQUIRE(buffers.insert(block.memory).second);
+            }
+
+            REQUIRE_THROWS_AS(pool.allocate(1025, 512),
+                              gregjm::BadAllocationException);
+            REQUIRE_THROWS_AS(pool.allocate(512, 8192),
+                              gregjm::BadAllocationException);
+        } AND_THEN("a freed buffer is handed out again") {
+            const gregjm::MemoryBlock block = pool.allocate(100, 0);
+            pool.deallocate(block);
+
+            REQUIRE_FALSE(pool.owns(block));
+            REQUIRE(pool.allocate(100, 0).memory == block.memory);
+        } AND_THEN("a double free is refused") {
+            const gregjm::MemoryBlock block = pool.allocate(100, 0);
+            pool.deallocate(block);
+
+            REQUIRE_THROWS_AS(pool.deallocate(block),
+                              gregjm::NotOwnedException);
+            REQUIRE_THROWS_AS(pool.reallocate(block, 200, 0),
+                              gregjm::NotOwnedException);
+
+            const gregjm::MemoryBlock first = pool.allocate(100, 0);
+            const gregjm::MemoryBlock second = pool.allocate(100, 0);
+
+            REQUIRE(first.memory != second.memory);
+        } AND_THEN("a pointer into a buffer is refused") {
+            const gregjm::MemoryBlock block = pool.allocate(1024, 0);
+            const gregjm::MemoryBlock inside{
+                static_cast<std::uint8_t*>(block.memory) + 100, 100
+            };
+
+            REQUIRE_FALSE(pool.owns(inside));
+            REQUIRE_THROWS_AS(pool.deallocate(inside),
+                              gregjm::NotOwnedException);
+
+            // the cache only ever holds whole buffers
+            for (int i = 0; i < 100; ++i) {
+                const auto address = reinterpret_cast<std::uintptr_t>(
+                    pool.allocate(100, 0).memory
+                );
+
+                REQUIRE(address % 4096 == 0);
+            }
+        } AND_THEN("deallocate_all frees every buffer") {
+            const gregjm::MemoryBlock block = pool.allocate(100, 0);
+            pool.deallocate_all();
+
+            REQUIRE_FALSE(pool.owns(block));
+            REQUIRE_THROWS_AS(pool.deallocate(block),
+                              gregjm::NotOwnedException);
+        }
+    }
+
+    GIVEN("sizes and alignments that can't make a buffer") {
+        THEN("the pool refuses them") {
+            using PoolT = gregjm::DirectIoBufferPool<>;
+
+            REQUIRE_THROWS_AS(PoolT(0, gregjm::DirectIoAlignment{ 512, 512 }),
+                              gregjm::BadAllocationException);
+            REQUIRE_THROWS_AS(PoolT(512, gregjm::DirectIoAlignment{ 512, 0 }),
+                              gregjm::BadAllocationException);
+        }
+    }
+}
+
+TEST_CASE("DirectIoBufferPool is shared between threads",
+          "[DirectIoBufferPool]") {
+    GIVEN("a pool locked with std::mutex") {
+        gregjm::DirectIoBufferPool<std::mutex> pool{
+            4096, gregjm::DirectIoAlignment{ 4096, 4096 }
+        };
+
+        THEN("threads growing and recycling it never share a buffer") {
+            constexpr int NUM_THREADS = 4;
+            constexpr int NUM_BUFFERS = 200;
+
+            std::vector<std::vector<void*>> held(NUM_THREADS);
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&pool, &buffers = held[t]] {
+                    for (int round = 0; round < 10; ++round) {
+                        for (int i = 0; i < NUM_BUFFERS; ++i) {
+                            buffers.push_back(pool.allocate(4096, 0).memory);
+                        }
+
+                        for (int i = 0; i < NUM_BUFFERS / 2; ++i) {
+                            pool.deallocate(
+                                gregjm::MemoryBlock{ buffers.back(), 4096 }
+                            );
+                            buffers.pop_back();
+                        }
+                    }
+                });
+            }
+
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+
+            std::set<void*> unique;
+
+            for (const std::vector<void*> &buffers : held) {
+                for (void *const buffer : buffers) {
+                    REQUIRE(unique.insert(buffer).second);
+                }
+            }
+
+            REQUIRE(unique.size() == NUM_THREADS * NUM_BUFFERS * 10 / 2);
+        }
+    }
+}
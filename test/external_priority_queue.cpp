@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include "external_priority_queue.hpp"
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <vector>
+
+TEST_CASE("ExternalPriorityQueue spills to disk",
+          "[ExternalPriorityQueue]") {
+    GIVEN("a queue that holds 100 elements in memory") {
+        gregjm::ExternalPriorityQueue<int> queue{ 100 };
+
+        for (int i = 0; i < 10000; ++i) {
+            queue.push((i * 7919) % 10000);
+        }
+
+        THEN("the rest are spilled and everything comes out in order") {
+            REQUIRE(queue.size() == 10000);
+            REQUIRE(queue.spilled() == 9900);
+            REQUIRE(queue.runs() == 99);
+
+            for (int expected = 9999; expected >= 0; --expected) {
+                REQUIRE(queue.top() == expected);
+
+                queue.pop();
+            }
+
+            REQUIRE(queue.empty());
+            REQUIRE(queue.runs() == 0);
+        } AND_THEN("clearing it drops the runs") {
+            queue.clear();
+
+            REQUIRE(queue.empty());
+            REQUIRE(queue.runs() == 0);
+
+            queue.push(3);
+
+            REQUIRE(queue.top() == 3);
+        }
+    } GIVEN("a queue whose directory doesn't exist") {
+        gregjm::ExternalPriorityQueue<int> queue{ 2, "/nonexistent/gregjm" };
+
+        queue.push(1);
+        queue.push(2);
+
+        THEN("a push that has to spill throws and changes nothing") {
+            REQUIRE_THROWS_AS(queue.push(3), gregjm::BadAllocationException);
+            REQUIRE(queue.size() == 2);
+            REQUIRE(queue.top() == 2);
+        }
+    }
+}
+
+TEST_CASE("ExternalPriorityQueue mixed operations",
+          "[ExternalPriorityQueue]") {
+    GIVEN("a min queue with random pushes and pops") {
+        gregjm::ExternalPriorityQueue<std::uint64_t,
+                                      std::greater<std::uint64_t>> queue{ 64 };
+        std::multiset<std::uint64_t> expected;
+        std::uint64_t state = 1;
+
+        const auto next = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+            return state >> 33;
+        };
+
+        THEN("it agrees with a multiset") {
+            for (int i = 0; i < 50000; ++i) {
+                if (next() % 3 != 0 or expected.empty()) {
+                    const std::uint64_t value = next() % 1000;
+                    queue.push(value);
+                    expected.insert(value);
+                } else {
+                    REQUIRE(queue.top() == *expected.begin());
+
+                    queue.pop();
+                    expected.erase(expected.begin());
+                }
+
+                REQUIRE(queue.size() == expected.size());
+            }
+
+            REQUIRE(queue.spilled() > 0);
+
+            while (not queue.empty()) {
+                REQUIRE(queue.top() == *expected.begin());
+
+                queue.pop();
+                expected.erase(expected.begin());
+            }
+
+            REQUIRE(expected.empty());
+        }
+    }
+}
+
+#endif
@@ -3,6 +3,10 @@
 #include "fibonacci_heap.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -160,3 +164,367 @@ TEST_CASE("FibonacciHeap custom comparators", "[FibonacciHeap]") {
         }
     }
 }
+
+TEST_CASE("FibonacciHeap pop", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap of shuffled ints") {
+        std::vector<int> values(1000);
+
+        for (int i = 0; i < 1000; ++i) {
+            values[i] = (i * 7919) % 1000;
+        }
+
+        gregjm::FibonacciHeap<int> heap{ values.cbegin(), values.cend() };
+
+        THEN("popping yields them in descending order") {
+            for (int expected = 999; expected >= 0; --expected) {
+                REQUIRE(heap.size() == static_cast<std::size_t>(expected + 1));
+                REQUIRE(heap.top() == expected);
+
+                heap.pop();
+            }
+
+            REQUIRE(heap.empty());
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap update", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap with handles to its elements") {
+        gregjm::FibonacciHeap<int> heap;
+        std::vector<gregjm::FibonacciHeap<int>::iterator> handles;
+
+        for (int i = 0; i < 100; ++i) {
+            handles.push_back(heap.push(i));
+        }
+
+        heap.pop(); // consolidates the rest into trees
+
+        THEN("raising an element moves it to the top") {
+            heap.update(handles[10], [](int &value) { value = 500; });
+
+            REQUIRE(heap.top() == 500);
+            REQUIRE(heap.size() == 99);
+
+            heap.pop();
+
+            REQUIRE(heap.top() == 98);
+        } AND_THEN("lowering the top moves it down") {
+            heap.update(handles[98], [](int &value) { value = -1; });
+
+            REQUIRE(heap.top() == 97);
+            REQUIRE(heap.size() == 99);
+        } AND_THEN("any mix of updates keeps the heap in order") {
+            std::multiset<int> expected;
+
+            for (int i = 0; i < 99; ++i) {
+                const int value = (i % 2 == 0) ? i * 3 : -i;
+                heap.update(handles[i], [value](int &x) { x = value; });
+                expected.insert(value);
+            }
+
+            for (auto iter = expected.crbegin(); iter != expected.crend();
+                 ++iter) {
+                REQUIRE(heap.top() == *iter);
+
+                heap.pop();
+            }
+
+            REQUIRE(heap.empty());
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap clear", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap with a long list of children") {
+        gregjm::FibonacciHeap<int> heap;
+
+        for (int i = 0; i < 1000000; ++i) {
+            heap.push(-i);
+        }
+
+        THEN("clearing it empties it without recursing") {
+            heap.clear();
+
+            REQUIRE(heap.empty());
+            REQUIRE(heap.size() == 0);
+            REQUIRE(heap.begin() == heap.end());
+
+            heap.push(1);
+
+            REQUIRE(heap.top() == 1);
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap batches", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap with some trees in it") {
+        gregjm::FibonacciHeap<int> heap;
+        std::multiset<int> expected;
+
+        for (int i = 0; i < 50; ++i) {
+            heap.push(i * 2);
+            expected.insert(i * 2);
+        }
+
+        heap.pop(); // consolidates the rest into trees
+        expected.erase(98);
+
+        THEN("a batch below the top is hung off it") {
+            const std::vector<int> batch{ 5, 91, -3, 5 };
+            heap.push_batch(batch.cbegin(), batch.cend());
+            expected.insert(batch.cbegin(), batch.cend());
+
+            REQUIRE(heap.size() == expected.size());
+            REQUIRE(heap.top() == 96);
+        } AND_THEN("a batch with a new best takes the top") {
+            const std::vector<int> batch{ 7, 1000, 99 };
+            heap.push_batch(batch.cbegin(), batch.cend());
+            expected.insert(batch.cbegin(), batch.cend());
+
+            REQUIRE(heap.top() == 1000);
+        } AND_THEN("an empty batch changes nothing") {
+            const std::vector<int> batch;
+            heap.push_batch(batch.cbegin(), batch.cend());
+
+            REQUIRE(heap.size() == expected.size());
+        }
+
+        std::vector<int> popped;
+
+        while (not heap.empty()) {
+            heap.pop_k(7, std::back_inserter(popped));
+        }
+
+        REQUIRE(std::equal(popped.cbegin(), popped.cend(),
+                           expected.crbegin(), expected.crend()));
+    } GIVEN("a FibonacciHeap of shuffled ints") {
+        std::vector<int> values(1000);
+
+        for (int i = 0; i < 1000; ++i) {
+            values[i] = (i * 7919) % 1000;
+        }
+
+        gregjm::FibonacciHeap<int> heap{ values.cbegin(), values.cend() };
+        std::vector<int> popped;
+
+        THEN("pop_k takes the k best in order and leaves the rest") {
+            heap.pop_k(10, std::back_inserter(popped));
+
+            REQUIRE(popped.size() == 10);
+            REQUIRE(popped.front() == 999);
+            REQUIRE(popped.back() == 990);
+            REQUIRE(heap.size() == 990);
+            REQUIRE(heap.top() == 989);
+
+            heap.pop();
+            heap.pop_k(2000, std::back_inserter(popped));
+
+            REQUIRE(popped.size() == 999);
+            REQUIRE(popped.back() == 0);
+            REQUIRE(heap.empty());
+        } AND_THEN("updates still work on what's left") {
+            std::vector<gregjm::FibonacciHeap<int>::iterator> handles;
+
+            for (int i = 0; i < 100; ++i) {
+                handles.push_back(heap.push(2000 + i));
+            }
+
+            heap.pop_k(50, std::back_inserter(popped));
+            heap.update(handles[0], [](int &value) { value = 5000; });
+            heap.update(handles[49], [](int &value) { value = -1; });
+
+            REQUIRE(heap.top() == 5000);
+
+            heap.pop_k(51, std::back_inserter(popped));
+
+            REQUIRE(popped.back() == 998);
+            REQUIRE(heap.top() == 997);
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap erase", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap with handles to its elements") {
+        gregjm::FibonacciHeap<int> heap;
+        std::vector<gregjm::FibonacciHeap<int>::iterator> handles;
+
+        for (int i = 0; i < 100; ++i) {
+            handles.push_back(heap.push(i));
+        }
+
+        heap.pop(); // consolidates the rest into trees
+
+        THEN("erasing removes elements from anywhere") {
+            for (int i = 0; i < 99; i += 3) {
+                heap.erase(handles[i]);
+            }
+
+            REQUIRE(heap.size() == 99 - 33);
+            REQUIRE(heap.top() == 98);
+
+            heap.erase(handles[98]);
+
+            REQUIRE(heap.top() == 97);
+        } AND_THEN("erasing lazily leaves tombstones that are skipped") {
+            for (int i = 0; i < 99; i += 3) {
+                heap.erase_lazily(handles[i]);
+            }
+
+            REQUIRE(heap.size() == 99 - 33);
+            REQUIRE(std::distance(heap.begin(), heap.end()) == 99 - 33);
+            REQUIRE(std::none_of(heap.begin(), heap.end(),
+                                 [](int x) { return x % 3 == 0; }));
+
+            std::vector<int> popped;
+            heap.pop_k(10, std::back_inserter(popped));
+
+            REQUIRE(popped == std::vector<int>{ 98, 97, 95, 94, 92, 91, 89,
+                                                88, 86, 85 });
+
+            heap.update(handles[1], [](int &value) { value = 1000; });
+
+            REQUIRE(heap.top() == 1000);
+
+            int last = 1001;
+
+            while (not heap.empty()) {
+                REQUIRE(heap.top() < last);
+                REQUIRE(heap.top() % 3 != 0);
+
+                last = heap.top();
+                heap.pop();
+            }
+        } AND_THEN("erasing most of the heap lazily reclaims it") {
+            for (int i = 0; i < 99; ++i) {
+                heap.erase_lazily(handles[i]);
+            }
+
+            REQUIRE(heap.size() == 0);
+            REQUIRE(heap.begin() == heap.end());
+
+            heap.push(5);
+
+            REQUIRE(heap.top() == 5);
+            REQUIRE(heap.size() == 1);
+        }
+    } GIVEN("a FibonacciHeap with random pushes, pops, updates and erases") {
+        using HeapT = gregjm::FibonacciHeap<int>;
+
+        HeapT heap;
+        std::vector<HeapT::iterator> handles(500);
+        std::vector<bool> is_live(500, false);
+        std::multiset<int> expected;
+        std::uint64_t state = 1;
+
+        const auto next = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+            return static_cast<int>(state >> 33);
+        };
+
+        THEN("it agrees with a multiset") {
+            for (int i = 0; i < 20000; ++i) {
+                const std::size_t index = next() % handles.size();
+                const int priority = next() % 1000;
+
+                switch (next() % 5) {
+                case 0:
+                    if (not is_live[index]) {
+                        handles[index] = heap.push(priority);
+                        is_live[index] = true;
+                        expected.insert(priority);
+                    }
+
+                    break;
+                case 1:
+                    if (is_live[index]) {
+                        expected.erase(expected.find(*handles[index]));
+                        expected.insert(priority);
+                        heap.update(handles[index], [priority](int &x) {
+                            x = priority;
+                        });
+                    }
+
+                    break;
+                case 2:
+                    if (is_live[index]) {
+                        expected.erase(expected.find(*handles[index]));
+                        heap.erase(handles[index]);
+                        is_live[index] = false;
+                    }
+
+                    break;
+                case 3:
+                    if (is_live[index]) {
+                        expected.erase(expected.find(*handles[index]));
+                        heap.erase_lazily(handles[index]);
+                        is_live[index] = false;
+                    }
+
+                    break;
+                default:
+                    if (not heap.empty()) {
+                        REQUIRE(heap.top() == *expected.rbegin());
+
+                        for (std::size_t j = 0; j < handles.size(); ++j) {
+                            if (is_live[j] and &*handles[j] == &heap.top()) {
+                                is_live[j] = false;
+                            }
+                        }
+
+                        expected.erase(std::prev(expected.end()));
+                        heap.pop();
+                    }
+                }
+
+                REQUIRE(heap.size() == expected.size());
+            }
+
+            REQUIRE(std::distance(heap.begin(), heap.end())
+                    == static_cast<std::ptrdiff_t>(expected.size()));
+        }
+    }
+}
+
+TEST_CASE("FibonacciHeap stats", "[FibonacciHeap]") {
+    GIVEN("a FibonacciHeap that counts what it does") {
+        using HeapT = gregjm::FibonacciHeap<int, std::less<int>,
+                                            std::allocator<int>,
+                                            gregjm::HeapStats>;
+
+        HeapT heap;
+        std::vector<HeapT::iterator> handles;
+
+        // the first is on top throughout, so the rest are its children
+        for (int i = 99; i >= 0; --i) {
+            handles.push_back(heap.push(i));
+        }
+
+        THEN("each push allocates once and links once") {
+            REQUIRE(heap.stats().allocations == 100);
+            REQUIRE(heap.stats().links == 99);
+            REQUIRE(heap.stats().comparisons == 99);
+            REQUIRE(heap.stats().consolidations == 0);
+        } AND_THEN("a pop consolidates the top's children") {
+            heap.pop();
+
+            REQUIRE(heap.stats().consolidations == 1);
+            REQUIRE(heap.stats().max_root_list == 99);
+            REQUIRE(heap.stats().links == 99 + 98);
+            REQUIRE(heap.stats().comparisons == 99 + 98);
+        } AND_THEN("raising elements deep in the trees cuts their parents") {
+            heap.pop();
+            heap.reset_stats();
+
+            for (int i = 1; i < 100; ++i) {
+                heap.update(handles[i], [i](int &value) {
+                    value = 1000 + i;
+                });
+            }
+
+            REQUIRE(heap.stats().cascading_cuts > 0);
+            REQUIRE(heap.stats().allocations == 0);
+            REQUIRE(heap.top() == 1099);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include "csr_graph.hpp"
+#include "graph_algorithms.hpp"
+#include "stack_allocator.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using Edge = gregjm::WeightedEdge<std::uint32_t>;
+
+constexpr std::uint32_t INF = gregjm::unreachable<std::uint32_t>();
+
+TEST_CASE("CsrGraph construction", "[CsrGraph]") {
+    gregjm::StackAllocator<1 << 12> alloc;
+    const std::vector<Edge> edges{ { 0, 1, 5 }, { 2, 0, 1 }, { 0, 2, 3 } };
+
+    GIVEN("a directed graph") {
+        const gregjm::CsrGraph<> graph{ 4, edges.cbegin(), edges.cend(),
+                                        alloc };
+
+        THEN("each vertex has its outgoing arcs") {
+            REQUIRE(graph.num_vertices() == 4);
+            REQUIRE(graph.num_arcs() == 3);
+            REQUIRE(graph.degree(0) == 2);
+            REQUIRE(graph.degree(1) == 0);
+            REQUIRE(graph.degree(2) == 1);
+            REQUIRE(graph.degree(3) == 0);
+            REQUIRE(graph.arcs(2).begin()->target == 0);
+            REQUIRE(graph.arcs(2).begin()->weight == 1);
+        }
+    } GIVEN("an undirected graph") {
+        const gregjm::CsrGraph<> graph{ 4, edges.cbegin(), edges.cend(),
+                                        alloc, true };
+
+        THEN("each edge is stored both ways") {
+            REQUIRE(graph.num_arcs() == 6);
+            REQUIRE(graph.degree(0) == 3);
+            REQUIRE(graph.degree(1) == 1);
+            REQUIRE(graph.degree(2) == 2);
+        }
+    } GIVEN("an edge to a vertex that doesn't exist") {
+        THEN("construction throws") {
+            REQUIRE_THROWS_AS((gregjm::CsrGraph<>{ 2, edges.cbegin(),
+                                                   edges.cend(), alloc }),
+                              std::out_of_range);
+        }
+    }
+}
+
+TEST_CASE("shortest paths and spanning trees", "[CsrGraph]") {
+    gregjm::StackAllocator<1 << 12> alloc;
+    const std::vector<Edge> edges{
+        { 0, 1, 4 }, { 0, 2, 1 }, { 2, 1, 2 }, { 1, 3, 1 }, { 2, 3, 5 },
+        { 3, 4, 3 }
+    };
+
+    GIVEN("a directed graph with an unreachable vertex") {
+        const gregjm::CsrGraph<> graph{ 6, edges.cbegin(), edges.cend(),
+                                        alloc };
+        const std::vector<std::uint32_t> expected{ 0, 3, 1, 4, 7, INF };
+
+        THEN("dijkstra finds the same distances with either engine") {
+            gregjm::BinaryHeapEngine<std::uint32_t> engine;
+
+            REQUIRE(gregjm::dijkstra(graph, 0) == expected);
+            REQUIRE(gregjm::dijkstra(graph, 0, engine) == expected);
+        }
+    } GIVEN("the same graph, undirected") {
+        const gregjm::CsrGraph<> graph{ 6, edges.cbegin(), edges.cend(),
+                                        alloc, true };
+
+        THEN("prim finds the minimum spanning tree of the component") {
+            const gregjm::SpanningTree<std::uint32_t> tree =
+                gregjm::prim(graph, 0);
+
+            REQUIRE(tree.weight == 7);
+            REQUIRE(tree.parents[0] == gregjm::NO_VERTEX);
+            REQUIRE(tree.parents[1] == 2);
+            REQUIRE(tree.parents[2] == 0);
+            REQUIRE(tree.parents[3] == 1);
+            REQUIRE(tree.parents[4] == 3);
+            REQUIRE(tree.parents[5] == gregjm::NO_VERTEX);
+        }
+    }
+}
+
+TEST_CASE("graph loaders", "[CsrGraph]") {
+    gregjm::StackAllocator<1 << 12> alloc;
+
+    GIVEN("a DIMACS file") {
+        const char path[] = "graph_test.gr";
+        std::ofstream{ path } << "c a comment\np sp 3 3\na 1 2 7\r\n"
+                                 "a 2 3 1\na 3 1 2\n";
+
+        THEN("it loads with vertices numbered from 0") {
+            const auto graph = gregjm::load_dimacs(path, alloc);
+
+            REQUIRE(graph);
+            REQUIRE(graph->num_vertices() == 3);
+            REQUIRE(graph->num_arcs() == 3);
+            REQUIRE(gregjm::dijkstra(*graph, 0)
+                    == std::vector<std::uint32_t>{ 0, 7, 8 });
+        }
+
+        std::remove(path);
+    } GIVEN("an edge list without weights") {
+        const char path[] = "graph_test.txt";
+        std::ofstream{ path } << "# a comment\n0 1\n1 4\n\n4 0\n";
+
+        THEN("it loads with unit weights") {
+            const auto graph = gregjm::load_edge_list(path, alloc);
+
+            REQUIRE(graph);
+            REQUIRE(graph->num_vertices() == 5);
+            REQUIRE(graph->num_arcs() == 3);
+            REQUIRE(gregjm::dijkstra(*graph, 0)[4] == 2);
+        }
+
+        std::remove(path);
+    } GIVEN("a file that isn't a graph") {
+        const char path[] = "graph_test.gr";
+        std::ofstream{ path } << "a 1 2 3\n";
+
+        THEN("loading fails") {
+            REQUIRE_FALSE(gregjm::load_dimacs(path, alloc));
+            REQUIRE_FALSE(gregjm::load_dimacs("no_such_graph.gr", alloc));
+        }
+
+        std::remove(path);
+    }
+}
@@ -0,0 +1,229 @@
+#include "catch.hpp"
+
+#include "intrusive_fibonacci_heap.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <vector>
+
+namespace {
+
+struct Task : gregjm::FibonacciHeapHook<> {
+    explicit Task(const int p = 0) noexcept : priority{ p } { }
+
+    friend bool operator<(const Task &lhs, const Task &rhs) noexcept {
+        return lhs.priority < rhs.priority;
+    }
+
+    int priority;
+};
+
+struct ByDeadline { };
+
+// in two heaps at once: one by priority, one by deadline
+struct Job : gregjm::FibonacciHeapHook<>,
+             gregjm::FibonacciHeapHook<ByDeadline> {
+    int priority;
+    int deadline;
+};
+
+struct EarlierDeadline {
+    bool operator()(const Job &lhs, const Job &rhs) const noexcept {
+        return lhs.deadline > rhs.deadline;
+    }
+};
+
+struct LowerPriority {
+    bool operator()(const Job &lhs, const Job &rhs) const noexcept {
+        return lhs.priority < rhs.priority;
+    }
+};
+
+} // namespace
+
+TEST_CASE("IntrusiveFibonacciHeap basics", "[IntrusiveFibonacciHeap]") {
+    GIVEN("tasks in a heap") {
+        std::vector<Task> tasks;
+
+        for (int i = 0; i < 100; ++i) {
+            tasks.emplace_back((i * 37) % 100);
+        }
+
+        gregjm::IntrusiveFibonacciHeap<Task> heap;
+
+        for (Task &task : tasks) {
+            heap.push(task);
+        }
+
+        THEN("they come out in order and are unlinked") {
+            for (int expected = 99; expected >= 0; --expected) {
+                Task &top = heap.top();
+
+                REQUIRE(top.priority == expected);
+                REQUIRE(top.is_linked());
+
+                heap.pop();
+
+                REQUIRE_FALSE(top.is_linked());
+            }
+
+            REQUIRE(heap.empty());
+        } AND_THEN("they can be erased from anywhere") {
+            heap.pop(); // consolidates the rest into trees
+
+            for (Task &task : tasks) {
+                if (task.is_linked() and task.priority % 3 == 0) {
+                    heap.erase(task);
+
+                    REQUIRE_FALSE(task.is_linked());
+                }
+            }
+
+            REQUIRE(heap.size() == 99 - 33);
+
+            int last = 100;
+
+            while (not heap.empty()) {
+                REQUIRE(heap.top().priority < last);
+                REQUIRE(heap.top().priority % 3 != 0);
+
+                last = heap.top().priority;
+                heap.pop();
+            }
+        } AND_THEN("clearing unlinks everything") {
+            heap.clear();
+
+            for (const Task &task : tasks) {
+                REQUIRE_FALSE(task.is_linked());
+            }
+
+            heap.push(tasks[5]);
+
+            REQUIRE(heap.size() == 1);
+        }
+    }
+}
+
+TEST_CASE("IntrusiveFibonacciHeap updates", "[IntrusiveFibonacciHeap]") {
+    GIVEN("a heap with random pushes, pops, updates and erases") {
+        std::vector<Task> tasks(500);
+        std::multiset<int> expected;
+        gregjm::IntrusiveFibonacciHeap<Task> heap;
+        std::uint64_t state = 1;
+
+        const auto next = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+            return static_cast<int>(state >> 33);
+        };
+
+        THEN("it agrees with a multiset") {
+            for (int i = 0; i < 20000; ++i) {
+                Task &task = tasks[next() % tasks.size()];
+                const int priority = next() % 1000;
+
+                switch (next() % 4) {
+                case 0:
+                    if (not task.is_linked()) {
+                        task.priority = priority;
+                        heap.push(task);
+                        expected.insert(priority);
+                    }
+
+                    break;
+                case 1:
+                    if (task.is_linked()) {
+                        expected.erase(expected.find(task.priority));
+                        expected.insert(priority);
+                        heap.update(task, [priority](Task &t) {
+                            t.priority = priority;
+                        });
+                    }
+
+                    break;
+                case 2:
+                    if (task.is_linked()) {
+                        expected.erase(expected.find(task.priority));
+                        heap.erase(task);
+                    }
+
+                    break;
+                default:
+                    if (not heap.empty()) {
+                        REQUIRE(heap.top().priority == *expected.rbegin());
+
+                        expected.erase(std::prev(expected.end()));
+                        heap.pop();
+                    }
+                }
+
+                REQUIRE(heap.size() == expected.size());
+            }
+        }
+    }
+}
+
+TEST_CASE("IntrusiveFibonacciHeap tags", "[IntrusiveFibonacciHeap]") {
+    GIVEN("jobs in a heap by priority and another by deadline") {
+        std::vector<Job> jobs(3);
+        jobs[0].priority = 1;
+        jobs[0].deadline = 30;
+        jobs[1].priority = 3;
+        jobs[1].deadline = 20;
+        jobs[2].priority = 2;
+        jobs[2].deadline = 10;
+
+        gregjm::IntrusiveFibonacciHeap<Job, LowerPriority> by_priority;
+        gregjm::IntrusiveFibonacciHeap<Job, EarlierDeadline,
+                                       ByDeadline> by_deadline;
+
+        for (Job &job : jobs) {
+            by_priority.push(job);
+            by_deadline.push(job);
+        }
+
+        THEN("each heap orders them its own way") {
+            REQUIRE(&by_priority.top() == &jobs[1]);
+            REQUIRE(&by_deadline.top() == &jobs[2]);
+
+            by_deadline.erase(jobs[1]);
+
+            REQUIRE(&by_priority.top() == &jobs[1]);
+            REQUIRE(by_deadline.size() == 2);
+        }
+    }
+}
+
+TEST_CASE("IntrusiveFibonacciHeap stats", "[IntrusiveFibonacciHeap]") {
+    GIVEN("an IntrusiveFibonacciHeap that counts what it does") {
+        std::vector<Task> tasks;
+
+        for (int i = 99; i >= 0; --i) {
+            tasks.emplace_back(i);
+        }
+
+        gregjm::IntrusiveFibonacciHeap<Task, std::less<Task>, void,
+                                       gregjm::HeapStats> heap;
+
+        for (Task &task : tasks) {
+            heap.push(task);
+        }
+
+        THEN("pushes link and pops consolidate without allocating") {
+            REQUIRE(heap.stats().links == 99);
+            REQUIRE(heap.stats().comparisons == 99);
+
+            heap.pop();
+
+            REQUIRE(heap.stats().consolidations == 1);
+            REQUIRE(heap.stats().max_root_list == 99);
+            REQUIRE(heap.stats().allocations == 0);
+
+            heap.reset_stats();
+
+            REQUIRE(heap.stats().links == 0);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include "catch.hpp"
+
+#include "io_buffer_allocator.hpp"
+
+#include <cstdint>
+#include <memory>
+
+TEST_CASE("IoBufferAllocator recycles buffers", "[IoBufferAllocator]") {
+    GIVEN("an unregistered IoBufferAllocator") {
+        using AllocT = gregjm::IoBufferAllocator<1000, 4>;
+
+        const auto alloc = std::make_unique<AllocT>();
+
+        REQUIRE_FALSE(alloc->is_registered());
+
+        THEN("buffers are page aligned and handed out low indices first") {
+            for (std::uint32_t i = 0; i < 4; ++i) {
+                const gregjm::IoBuffer buffer = alloc->allocate_buffer(100);
+                const auto address =
+                    reinterpret_cast<std::uintptr_t>(buffer.block.memory);
+
+                REQUIRE(buffer.index == i);
+                REQUIRE(address % gregjm::page_size() == 0);
+                REQUIRE(alloc->buffer_index(buffer.block) == i);
+            }
+
+            REQUIRE_THROWS_AS(alloc->allocate_buffer(100),
+                              gregjm::BadAllocationException);
+        } AND_THEN("a freed buffer is handed out again") {
+            const gregjm::IoBuffer first = alloc->allocate_buffer(10);
+            alloc->deallocate(first.block);
+
+            REQUIRE(alloc->allocate_buffer(10).index == first.index);
+        } AND_THEN("a double free is refused") {
+            const gregjm::IoBuffer first = alloc->allocate_buffer(10);
+            alloc->deallocate(first.block);
+
+            REQUIRE_THROWS_AS(alloc->deallocate(first.block),
+                              gregjm::NotOwnedException);
+            REQUIRE_THROWS_AS(alloc->reallocate(first.block, 20, 16),
+                              gregjm::NotOwnedException);
+
+            // every buffer comes out exactly once
+            for (std::uint32_t i = 0; i < 4; ++i) {
+                REQUIRE(alloc->allocate_buffer(10).index == i);
+            }
+
+            REQUIRE_THROWS_AS(alloc->allocate_buffer(10),
+                              gregjm::BadAllocationException);
+        } AND_THEN("only buffers in use are owned") {
+            const gregjm::IoBuffer first = alloc->allocate_buffer(10);
+
+            REQUIRE(alloc->owns(first.block));
+            REQUIRE_FALSE(alloc->owns(alloc->buffer(3)));
+
+            alloc->deallocate(first.block);
+
+            REQUIRE_FALSE(alloc->owns(first.block));
+
+            int outside = 0;
+
+            REQUIRE_FALSE(alloc->owns(gregjm::MemoryBlock{ &outside, 4 }));
+        } AND_THEN("a buffer that was never handed out can't be freed") {
+            REQUIRE_THROWS_AS(alloc->deallocate(alloc->buffer(2)),
+                              gregjm::NotOwnedException);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include "key_payload_heap.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("KeyPayloadHeap ordering", "[KeyPayloadHeap]") {
+    GIVEN("a heap of payloads keyed by ints") {
+        gregjm::KeyPayloadHeap<int, std::string> heap;
+        std::vector<gregjm::KeyPayloadHeap<int, std::string>::handle> handles;
+
+        for (int i = 0; i < 100; ++i) {
+            const int key = (i * 37) % 100;
+            handles.push_back(heap.push(key, std::to_string(key)));
+        }
+
+        THEN("payloads come out with their keys in order") {
+            for (int expected = 99; expected >= 0; --expected) {
+                REQUIRE(heap.top_key() == expected);
+                REQUIRE(heap.top_payload() == std::to_string(expected));
+
+                heap.pop();
+            }
+
+            REQUIRE(heap.empty());
+        } AND_THEN("keys can be changed and elements erased by handle") {
+            heap.pop(); // consolidates the rest into trees
+
+            heap.update_key(handles[1], 1000);
+
+            REQUIRE(heap.top_key() == 1000);
+            REQUIRE(heap.top_payload() == "37");
+            REQUIRE(heap.key(handles[1]) == 1000);
+
+            heap.payload(handles[2]) = "changed";
+            heap.update_key(handles[2], -1);
+            heap.erase(handles[1]);
+
+            REQUIRE(heap.size() == 98);
+            REQUIRE(heap.top_key() == 98);
+
+            while (heap.size() > 1) {
+                heap.pop();
+            }
+
+            REQUIRE(heap.top_key() == -1);
+            REQUIRE(heap.top_payload() == "changed");
+        }
+    } GIVEN("a min heap with a custom comparator") {
+        gregjm::KeyPayloadHeap<double, int, std::greater<double>> heap;
+
+        heap.push(2.5, 2);
+        heap.push(0.5, 0);
+        heap.emplace(1.5, 1);
+
+        THEN("the least key is on top") {
+            REQUIRE(heap.top_payload() == 0);
+
+            heap.pop();
+
+            REQUIRE(heap.top_payload() == 1);
+        }
+    }
+}
+
+TEST_CASE("KeyPayloadHeap payload slots", "[KeyPayloadHeap]") {
+    GIVEN("a heap of payloads that are watched") {
+        gregjm::KeyPayloadHeap<int, std::shared_ptr<int>> heap;
+        const auto watched = std::make_shared<int>(0);
+
+        for (int i = 0; i < 10; ++i) {
+            heap.push(i, watched);
+        }
+
+        THEN("popping and erasing destroy payloads") {
+            REQUIRE(watched.use_count() == 11);
+
+            heap.pop();
+
+            REQUIRE(watched.use_count() == 10);
+
+            const auto handle = heap.push(-5, watched);
+            heap.erase(handle);
+
+            REQUIRE(watched.use_count() == 10);
+
+            heap.clear();
+
+            REQUIRE(watched.use_count() == 1);
+            REQUIRE(heap.empty());
+        } AND_THEN("pushing after popping keeps one payload per element") {
+            for (int i = 0; i < 1000; ++i) {
+                heap.pop();
+                heap.push(i, watched);
+            }
+
+            REQUIRE(heap.size() == 10);
+            REQUIRE(watched.use_count() == 11);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include "pool_allocator.hpp"
+#include "stack_allocator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using BaseT = gregjm::StackAllocator<std::size_t{ 1 } << 20>;
+using PoolT = gregjm::PoolAllocator<4096, BaseT>;
+
+static_assert(not std::is_move_constructible_v<PoolT>,
+              "PoolAllocator's containers can't follow alloc_");
+static_assert(not std::is_move_assignable_v<PoolT>,
+              "PoolAllocator's containers can't follow alloc_");
+
+} // namespace
+
+TEST_CASE("PoolAllocator grows one pool at a time", "[PoolAllocator]") {
+    GIVEN("a PoolAllocator over a stack") {
+        const auto pool = std::make_unique<PoolT>();
+
+        THEN("filling many pools hands out distinct aligned blocks") {
+            std::vector<gregjm::MemoryBlock> blocks;
+
+            for (int i = 0; i < 64; ++i) {
+                blocks.push_back(pool->allocate(4096, 64));
+            }
+
+            for (std::size_t i = 0; i < blocks.size(); ++i) {
+                const auto address =
+                    reinterpret_cast<std::uintptr_t>(blocks[i].memory);
+
+                REQUIRE(address % 4096 == 0);
+                REQUIRE(pool->owns(blocks[i]));
+
+                for (std::size_t j = 0; j < i; ++j) {
+                    REQUIRE(blocks[i].memory != blocks[j].memory);
+                }
+            }
+
+            for (const gregjm::MemoryBlock block : blocks) {
+                pool->deallocate(block);
+            }
+
+            const gregjm::MemoryBlock block = pool->allocate(16, 16);
+
+            REQUIRE(pool->owns(block));
+        } AND_THEN("reserve prefaults each new pool with the callable") {
+            std::vector<gregjm::MemoryBlock> regions;
+            const auto record = [&regions](void *const memory,
+                                           const std::size_t size) {
+                regions.push_back(gregjm::MemoryBlock{ memory, size });
+            };
+
+            REQUIRE(pool->reserve(4, record) == 4);
+            REQUIRE(pool->reserve(2, record) == 0);
+            REQUIRE(regions.size() == 4);
+
+            for (const gregjm::MemoryBlock region : regions) {
+                REQUIRE(region.size == 4096);
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+
+#include "radix_heap.hpp"
+#include "csr_graph.hpp"
+#include "graph_algorithms.hpp"
+#include "stack_allocator.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("RadixHeap pop", "[RadixHeap]") {
+    GIVEN("a RadixHeap of shuffled keys") {
+        gregjm::RadixHeap<std::uint32_t, int> heap;
+
+        for (int i = 0; i < 1000; ++i) {
+            heap.push({ static_cast<std::uint32_t>((i * 7919) % 1000), i });
+        }
+
+        THEN("popping yields them in ascending order") {
+            for (std::uint32_t expected = 0; expected < 1000; ++expected) {
+                REQUIRE(heap.size() == 1000 - expected);
+                REQUIRE(heap.top().first == expected);
+                REQUIRE((heap.top().second * 7919) % 1000
+                        == static_cast<int>(expected));
+
+                heap.pop();
+            }
+
+            REQUIRE(heap.empty());
+        } AND_THEN("moving it leaves the source empty and usable") {
+            heap.pop();
+
+            gregjm::RadixHeap<std::uint32_t, int> moved{ std::move(heap) };
+
+            REQUIRE(moved.size() == 999);
+            REQUIRE(moved.top().first == 1);
+            REQUIRE(heap.empty());
+            REQUIRE(heap.size() == 0);
+            REQUIRE(heap.last_key() == 0);
+
+            heap.push({ 0, -1 });
+
+            REQUIRE(heap.top().second == -1);
+
+            heap = std::move(moved);
+
+            REQUIRE(heap.size() == 999);
+            REQUIRE(heap.top().first == 1);
+            REQUIRE(moved.empty());
+            REQUIRE(moved.last_key() == 0);
+        }
+    } GIVEN("an empty RadixHeap") {
+        gregjm::RadixHeap<std::uint8_t, std::string> heap;
+
+        THEN("the first push may have any key") {
+            heap.emplace(200, 3, 'x');
+            heap.emplace(100, "y");
+
+            REQUIRE(heap.top().second == "y");
+
+            heap.pop();
+
+            REQUIRE(heap.last_key() == 100);
+            REQUIRE(heap.top().first == 200);
+            REQUIRE(heap.top().second == "xxx");
+        } AND_THEN("keys may start over after a clear") {
+            heap.emplace(255, "late");
+            heap.pop();
+            heap.clear();
+            heap.emplace(0, "early");
+
+            REQUIRE(heap.top().second == "early");
+        }
+    }
+}
+
+TEST_CASE("RadixHeap monotone workloads", "[RadixHeap]") {
+    GIVEN("pushes interleaved with pops, keys never below the last pop") {
+        gregjm::RadixHeap<std::uint64_t, std::uint32_t> heap;
+        std::multimap<std::uint64_t, std::uint32_t> reference;
+        std::uint64_t state = 1;
+
+        const auto next = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+            return state >> 33;
+        };
+
+        THEN("it pops the same keys as an ordered map") {
+            for (std::uint32_t i = 0; i < 10000; ++i) {
+                if (reference.empty() or next() % 3 != 0) {
+                    // gaps of up to 2^40 spread keys over most buckets, and
+                    // the many small ones make ties
+                    const std::uint64_t gap =
+                        ((next() << 31) | next()) >> (next() % 42 + 22);
+                    const std::uint64_t key = heap.last_key() + gap;
+
+                    heap.push({ key, i });
+                    reference.emplace(key, i);
+                } else {
+                    // ties may come out in any order, but pop has to
+                    // remove the element top returned
+                    const auto [key, value] = heap.top();
+                    auto [first, last] = reference.equal_range(key);
+
+                    REQUIRE(key == reference.begin()->first);
+
+                    while (first != last and first->second != value) {
+                        ++first;
+                    }
+
+                    REQUIRE(first != last);
+
+                    heap.pop();
+                    reference.erase(first);
+                }
+
+                REQUIRE(heap.size() == reference.size());
+            }
+        }
+    }
+}
+
+TEST_CASE("RadixHeap with a PolymorphicAllocator", "[RadixHeap]") {
+    using EntryT = std::pair<std::uint32_t, gregjm::VertexId>;
+
+    gregjm::StackAllocator<1 << 16> alloc;
+
+    GIVEN("a RadixHeapEngine drawing from a StackAllocator") {
+        const std::vector<gregjm::WeightedEdge<std::uint32_t>> edges{
+            { 0, 1, 4 }, { 0, 2, 1 }, { 2, 1, 2 }, { 1, 3, 1 }, { 2, 3, 5 },
+            { 3, 4, 3 }
+        };
+        const gregjm::CsrGraph<> graph{ 6, edges.cbegin(), edges.cend(),
+                                        alloc };
+        gregjm::RadixHeapEngine<
+            std::uint32_t, gregjm::PolymorphicAllocatorAdaptor<EntryT>
+        > engine{ gregjm::make_adaptor<EntryT>(alloc) };
+
+        THEN("dijkstra finds the same distances as with a FibonacciHeap") {
+            REQUIRE(gregjm::dijkstra(graph, 0, engine)
+                    == gregjm::dijkstra(graph, 0));
+        }
+    }
+}
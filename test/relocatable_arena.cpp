@@ -0,0 +1,153 @@
+#include "catch.hpp"
+
+#include "relocatable_arena.hpp"
+
+#if defined(__linux__)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr const char *RELOCATABLE_TEST_FILE = "relocatable_arena_test.bin";
+
+// how much of the mapping holding address has been copied into anonymous
+// memory, according to /proc/self/smaps
+std::size_t anonymous_kib(const void *const address) {
+    const auto target = reinterpret_cast<std::uintptr_t>(address);
+    std::ifstream smaps{ "/proc/self/smaps" };
+    std::string line;
+    bool in_mapping = false;
+
+    while (std::getline(smaps, line)) {
+        std::uintptr_t start;
+        std::uintptr_t end;
+        char dash;
+        std::istringstream fields{ line };
+
+        if (fields >> std::hex >> start >> dash >> end and dash == '-') {
+            in_mapping = (start <= target and target < end);
+        } else if (in_mapping and line.rfind("Anonymous:", 0) == 0) {
+            std::istringstream value{ line.substr(10) };
+            std::size_t kib;
+            value >> kib;
+
+            return kib;
+        }
+    }
+
+    FAIL("no mapping holds the address");
+
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE("RelocatableArena forgets slots a shrink gives up",
+          "[RelocatableArena]") {
+    GIVEN("a pointer slot in the top block") {
+        gregjm::RelocatableArena<> arena{ 4096 };
+        const gregjm::MemoryBlock first = arena.allocate(8, 8);
+        auto *&slot = *static_cast<void**>(first.memory);
+        arena.store_pointer(slot, first.memory);
+
+        WHEN("the block shrinks under the slot and the space is reused") {
+            const gregjm::MemoryBlock shrunk = arena.reallocate(first, 4, 8);
+
+            REQUIRE(shrunk.memory == first.memory);
+
+            const gregjm::MemoryBlock second = arena.allocate(12, 1);
+            std::memset(second.memory, 0xff, second.size);
+
+            THEN("the slot isn't checked or relocated") {
+                REQUIRE(arena.save(RELOCATABLE_TEST_FILE));
+
+                const gregjm::MappedArena loaded =
+                    gregjm::MappedArena::load(RELOCATABLE_TEST_FILE);
+
+                REQUIRE(loaded);
+                REQUIRE(loaded.memory().size == 16);
+
+                const auto *const bytes =
+                    static_cast<const std::uint8_t*>(loaded.memory().memory);
+
+                for (std::size_t i = 4; i < 16; ++i) {
+                    REQUIRE(bytes[i] == 0xff);
+                }
+            }
+        }
+
+        THEN("slots and roots have to lie below the top") {
+            // the top is at 12, so a slot at 8 would end past it
+            static_cast<void>(arena.allocate(4, 1));
+
+            auto *const straddling = static_cast<void**>(first.memory) + 1;
+            auto *const top = static_cast<std::uint8_t*>(first.memory) + 12;
+
+            REQUIRE_THROWS_AS(arena.register_pointer(*straddling),
+                              gregjm::NotOwnedException);
+            REQUIRE_THROWS_AS(arena.set_root(top),
+                              gregjm::NotOwnedException);
+        }
+    }
+
+    unlink(RELOCATABLE_TEST_FILE);
+}
+
+TEST_CASE("MappedArena shares pages it doesn't fix up",
+          "[RelocatableArena]") {
+    const std::size_t page = gregjm::page_size();
+    const std::size_t num_pages = 64;
+
+    GIVEN("a saved arena spanning many pages") {
+        const auto saved = std::make_unique<gregjm::RelocatableArena<>>(
+            num_pages * page
+        );
+        const gregjm::MemoryBlock block = saved->allocate(num_pages * page,
+                                                          page);
+        std::memset(block.memory, 0x5a, block.size);
+        saved->set_root(block.memory);
+
+        WHEN("it holds no pointers") {
+            REQUIRE(saved->save(RELOCATABLE_TEST_FILE));
+
+            const gregjm::MappedArena loaded =
+                gregjm::MappedArena::load(RELOCATABLE_TEST_FILE);
+
+            THEN("none of it is copied") {
+                REQUIRE(loaded);
+                REQUIRE(*loaded.root<std::uint8_t>() == 0x5a);
+                REQUIRE(anonymous_kib(loaded.memory().memory) == 0);
+            }
+        } AND_WHEN("it holds one pointer and has to move") {
+            auto *&slot = *static_cast<void**>(block.memory);
+            saved->store_pointer(slot, block.memory);
+
+            REQUIRE(saved->save(RELOCATABLE_TEST_FILE));
+
+            // the original still holds its range, so the load lands
+            // elsewhere
+            const gregjm::MappedArena loaded =
+                gregjm::MappedArena::load(RELOCATABLE_TEST_FILE);
+
+            THEN("only the page holding the pointer is copied") {
+                REQUIRE(loaded);
+                REQUIRE(*loaded.root<const void*>()
+                        == loaded.memory().memory);
+                REQUIRE(anonymous_kib(loaded.memory().memory)
+                        == page / 1024);
+            }
+        }
+    }
+
+    unlink(RELOCATABLE_TEST_FILE);
+}
+
+#endif
@@ -5,13 +5,46 @@
 #include "fallback_allocator.hpp"
 #include "pool_allocator.hpp"
 #include "segregating_allocator.hpp"
-
+#include "lock_free_free_list.hpp"
+#include "direct_io_buffer_pool.hpp"
+#include "ring_allocator.hpp"
+#include "mirrored_ring_buffer.hpp"
+#include "splice_arena.hpp"
+#include "snapshot_arena.hpp"
+#include "relocatable_arena.hpp"
+#include "virtual_arena.hpp"
+#include "tiered_arena.hpp"
+#include "csr_graph.hpp"
+#include "graph_algorithms.hpp"
+#include "radix_heap.hpp"
+#include "timing_wheel.hpp"
+#include "bounded_heap.hpp"
+#include "intrusive_fibonacci_heap.hpp"
+#include "fibonacci_heap.hpp"
+#include "heap_stats.hpp"
+#include "key_payload_heap.hpp"
+#include "external_priority_queue.hpp"
+
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <mutex>
 #include <chrono>
 #include <utility>
 #include <random>
+#include <thread>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 constexpr unsigned long long
 operator""_KiB(unsigned long long literal) noexcept {
@@ -248,6 +281,835 @@ void segregating_pool_test(std::size_t num) {
     }
 }
 
+// the mutex-guarded list that LockFreeFreeList is measured against
+template <typename Mutex>
+class LockedFreeList {
+public:
+    void push(void *const memory) {
+        const std::scoped_lock<Mutex> lock{ mutex_ };
+
+        head_ = new (memory) gregjm::FreeListNode{ head_ };
+    }
+
+    void* pop() {
+        const std::scoped_lock<Mutex> lock{ mutex_ };
+
+        gregjm::FreeListNode *const node = head_;
+
+        if (node) {
+            head_ = node->next.load(std::memory_order_relaxed);
+        }
+
+        return node;
+    }
+
+private:
+    Mutex mutex_;
+    gregjm::FreeListNode *head_ = nullptr;
+};
+
+constexpr std::size_t FREE_LIST_NODES = 1 << 12;
+constexpr std::size_t FREE_LIST_OPERATIONS = 1 << 16;
+
+// every thread repeatedly pops a few blocks, scribbles on them and pushes
+// them back
+template <typename List>
+void free_list_test(const std::size_t num_threads) {
+    struct alignas(64) Block {
+        unsigned char bytes[64];
+    };
+
+    std::vector<Block> blocks(FREE_LIST_NODES);
+    List list;
+
+    for (Block &block : blocks) {
+        list.push(&block);
+    }
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&list] {
+            void *held[4];
+
+            for (std::size_t j = 0; j < FREE_LIST_OPERATIONS; ++j) {
+                std::size_t count = 0;
+
+                for (; count < 4; ++count) {
+                    held[count] = list.pop();
+
+                    if (not held[count]) {
+                        break;
+                    }
+
+                    static_cast<unsigned char*>(held[count])[63] = 0;
+                }
+
+                for (std::size_t k = 0; k < count; ++k) {
+                    list.push(held[k]);
+                }
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+constexpr std::size_t RING_SIZE = 256_KiB;
+constexpr std::size_t RING_WINDOW = 256;
+constexpr std::size_t RING_MESSAGES = 1 << 16;
+
+// a streaming stage: every message is freed once RING_WINDOW newer ones have
+// been allocated, so blocks come back in the order they went out
+void ring_test(gregjm::PolymorphicAllocator &alloc) {
+    std::mt19937 engine{ generator() };
+    std::uniform_int_distribution<std::size_t> distribution{ 16, 1_KiB };
+    std::vector<gregjm::MemoryBlock> window(RING_WINDOW);
+
+    for (std::size_t i = 0; i < RING_MESSAGES; ++i) {
+        gregjm::MemoryBlock &slot = window[i % RING_WINDOW];
+
+        if (i >= RING_WINDOW) {
+            alloc.deallocate(slot);
+        }
+
+        slot = alloc.allocate(distribution(engine), alignof(double));
+        static_cast<unsigned char*>(slot.memory)[0] = 0;
+    }
+
+    for (std::size_t i = 0; i < std::min(RING_MESSAGES, RING_WINDOW); ++i) {
+        alloc.deallocate(window[i]);
+    }
+}
+
+constexpr std::size_t STREAM_BUFFER_SIZE = 64_KiB;
+constexpr std::size_t STREAM_RECORDS = 1 << 18;
+constexpr std::size_t STREAM_MAX_RECORD = 1_KiB;
+
+// a plain ring buffer, where records that straddle the end have to be
+// written and read in two pieces
+class WrappingRingBuffer {
+public:
+    explicit WrappingRingBuffer(const std::size_t capacity)
+    : data_(capacity) { }
+
+    std::size_t free_space() const noexcept {
+        return data_.size() - (head_ - tail_);
+    }
+
+    std::size_t size() const noexcept {
+        return head_ - tail_;
+    }
+
+    void write(const void *const memory, const std::size_t count) {
+        const std::size_t offset = head_ % data_.size();
+        const std::size_t first = std::min(count, data_.size() - offset);
+
+        std::memcpy(data_.data() + offset, memory, first);
+        std::memcpy(data_.data(),
+                    static_cast<const unsigned char*>(memory) + first,
+                    count - first);
+        head_ += count;
+    }
+
+    // points into the buffer if the next count bytes are contiguous and
+    // copies them into scratch if not
+    const unsigned char* peek(unsigned char *const scratch,
+                              const std::size_t count) const {
+        const std::size_t offset = tail_ % data_.size();
+        const std::size_t first = std::min(count, data_.size() - offset);
+
+        if (first == count) {
+            return data_.data() + offset;
+        }
+
+        std::memcpy(scratch, data_.data() + offset, first);
+        std::memcpy(scratch + first, data_.data(), count - first);
+
+        return scratch;
+    }
+
+    void consume(const std::size_t count) noexcept {
+        tail_ += count;
+    }
+
+private:
+    std::vector<unsigned char> data_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+};
+
+using RecordLengthT = std::uint32_t;
+
+std::uint64_t parse_record(const unsigned char *const payload,
+                           const std::size_t size) {
+    return std::accumulate(payload, payload + size, std::uint64_t{ 0 });
+}
+
+// length-prefixed records are written until the buffer fills up, then all
+// of them are parsed
+std::uint64_t mirrored_stream_test() {
+    gregjm::MirroredRingBuffer buffer{ STREAM_BUFFER_SIZE };
+    std::mt19937 engine{ 0 };
+    std::uniform_int_distribution<RecordLengthT> distribution{
+        0, STREAM_MAX_RECORD
+    };
+    std::uint64_t checksum = 0;
+
+    const auto drain = [&buffer, &checksum] {
+        while (not buffer.empty()) {
+            const auto *const record =
+                static_cast<const unsigned char*>(buffer.read_block().memory);
+            RecordLengthT length;
+            std::memcpy(&length, record, sizeof(length));
+
+            checksum += parse_record(record + sizeof(length), length);
+            buffer.consume(sizeof(length) + length);
+        }
+    };
+
+    for (std::size_t i = 0; i < STREAM_RECORDS; ++i) {
+        const RecordLengthT length = distribution(engine);
+
+        if (buffer.write_block().size < sizeof(length) + length) {
+            drain();
+        }
+
+        auto *const record =
+            static_cast<unsigned char*>(buffer.write_block().memory);
+        std::memcpy(record, &length, sizeof(length));
+        std::memset(record + sizeof(length), static_cast<int>(i), length);
+        buffer.commit(sizeof(length) + length);
+    }
+
+    drain();
+
+    return checksum;
+}
+
+std::uint64_t wrapping_stream_test() {
+    WrappingRingBuffer buffer{ STREAM_BUFFER_SIZE };
+    std::mt19937 engine{ 0 };
+    std::uniform_int_distribution<RecordLengthT> distribution{
+        0, STREAM_MAX_RECORD
+    };
+    std::vector<unsigned char> record(STREAM_MAX_RECORD);
+    std::vector<unsigned char> scratch(STREAM_MAX_RECORD);
+    std::uint64_t checksum = 0;
+
+    const auto drain = [&buffer, &scratch, &checksum] {
+        while (buffer.size() != 0) {
+            RecordLengthT length;
+            std::memcpy(&length, buffer.peek(scratch.data(), sizeof(length)),
+                        sizeof(length));
+            buffer.consume(sizeof(length));
+
+            checksum += parse_record(buffer.peek(scratch.data(), length),
+                                     length);
+            buffer.consume(length);
+        }
+    };
+
+    for (std::size_t i = 0; i < STREAM_RECORDS; ++i) {
+        const RecordLengthT length = distribution(engine);
+
+        if (buffer.free_space() < sizeof(length) + length) {
+            drain();
+        }
+
+        std::memset(record.data(), static_cast<int>(i), length);
+        buffer.write(&length, sizeof(length));
+        buffer.write(record.data(), length);
+    }
+
+    drain();
+
+    return checksum;
+}
+
+constexpr std::size_t GROWTH_RESERVE = 1_GiB;
+constexpr std::size_t GROWTH_ELEMENTS = 1 << 24;
+
+// appends GROWTH_ELEMENTS values, doubling the buffer whenever it fills up.
+// the arena grows it where it is, where std::vector copies it every time
+std::uint64_t arena_growth_test(gregjm::VirtualArena<> &arena) {
+    gregjm::MemoryBlock block =
+        arena.allocate(sizeof(std::uint64_t), alignof(std::uint64_t));
+    std::size_t capacity = 1;
+
+    for (std::size_t i = 0; i < GROWTH_ELEMENTS; ++i) {
+        if (i == capacity) {
+            capacity *= 2;
+            block = arena.reallocate(block, capacity * sizeof(std::uint64_t),
+                                     alignof(std::uint64_t));
+        }
+
+        static_cast<std::uint64_t*>(block.memory)[i] = i;
+    }
+
+    const std::uint64_t middle =
+        static_cast<std::uint64_t*>(block.memory)[GROWTH_ELEMENTS / 2];
+
+    // gives the pages back, as freeing the vector would
+    arena.deallocate_all();
+
+    return middle;
+}
+
+std::uint64_t vector_growth_test() {
+    std::vector<std::uint64_t> values;
+
+    for (std::size_t i = 0; i < GROWTH_ELEMENTS; ++i) {
+        values.push_back(i);
+    }
+
+    return values[GROWTH_ELEMENTS / 2];
+}
+
+constexpr std::size_t PREFAULT_POOL_SIZE = 128_KiB;
+constexpr std::size_t PREFAULT_POOLS = 256;
+constexpr std::size_t PREFAULT_REQUEST_SIZE = 16_KiB;
+constexpr std::size_t PREFAULT_REQUESTS =
+    PREFAULT_POOLS * PREFAULT_POOL_SIZE / PREFAULT_REQUEST_SIZE;
+
+using PrefaultPoolT =
+    gregjm::PoolAllocator<PREFAULT_POOL_SIZE, gregjm::GlobalAllocator<>>;
+
+// the first requests after startup: each fills a fresh buffer and keeps it,
+// so the pool keeps needing new pools. returns the slowest request in
+// seconds
+template <typename Clock = std::chrono::steady_clock>
+long double serve_first_requests(PrefaultPoolT &pool) {
+    std::vector<gregjm::MemoryBlock> blocks;
+    blocks.reserve(PREFAULT_REQUESTS);
+    std::chrono::duration<long double> slowest{ 0 };
+
+    for (std::size_t i = 0; i < PREFAULT_REQUESTS; ++i) {
+        const auto start = Clock::now();
+
+        const gregjm::MemoryBlock block =
+            pool.allocate(PREFAULT_REQUEST_SIZE, alignof(double));
+        std::memset(block.memory, static_cast<int>(i), block.size);
+        blocks.push_back(block);
+
+        slowest = std::max(slowest, std::chrono::duration<long double>{
+            Clock::now() - start
+        });
+    }
+
+    for (const gregjm::MemoryBlock block : blocks) {
+        pool.deallocate(block);
+    }
+
+    return slowest.count();
+}
+
+constexpr gregjm::VertexId GRAPH_VERTICES = 1 << 20;
+constexpr std::size_t GRAPH_EDGES = 1 << 22;
+
+using GraphT = gregjm::CsrGraph<std::uint32_t>;
+using KeyedVertexT = gregjm::KeyedVertex<std::uint32_t>;
+
+// a ring, so that every vertex is reachable, plus random edges
+GraphT make_graph(gregjm::PolymorphicAllocator &alloc, const bool undirected) {
+    std::mt19937 engine{ 0x5eed };
+    std::uniform_int_distribution<gregjm::VertexId> vertex{
+        0, GRAPH_VERTICES - 1
+    };
+    std::uniform_int_distribution<std::uint32_t> weight{ 1, 1000 };
+    std::vector<gregjm::WeightedEdge<std::uint32_t>> edges;
+    edges.reserve(GRAPH_EDGES);
+
+    for (gregjm::VertexId i = 0; i < GRAPH_VERTICES; ++i) {
+        edges.push_back({ i, (i + 1) % GRAPH_VERTICES, weight(engine) });
+    }
+
+    while (edges.size() < GRAPH_EDGES) {
+        edges.push_back({ vertex(engine), vertex(engine), weight(engine) });
+    }
+
+    return GraphT{ GRAPH_VERTICES, edges.cbegin(), edges.cend(), alloc,
+                   undirected };
+}
+
+template <typename Engine>
+std::uint64_t dijkstra_test(const GraphT &graph, Engine &engine) {
+    const std::vector<std::uint32_t> distances =
+        gregjm::dijkstra(graph, 0, engine);
+
+    return std::accumulate(distances.cbegin(), distances.cend(),
+                           std::uint64_t{ 0 });
+}
+
+template <typename Engine>
+std::uint64_t prim_test(const GraphT &graph, Engine &engine) {
+    return gregjm::prim(graph, 0, engine).weight;
+}
+
+constexpr std::size_t HOLD_EVENTS = 1 << 20;
+constexpr std::size_t HOLD_STEPS = 1 << 22;
+
+using EventT = std::pair<std::uint64_t, std::uint32_t>;
+
+// a delay that depends only on the event, so heaps that break ties
+// differently still schedule the same events
+std::uint64_t hold_delay(const EventT &event) noexcept {
+    std::uint64_t hash = event.first * 0x9e3779b97f4a7c15ull ^ event.second;
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 32;
+
+    return 1 + hash % (1 << 20);
+}
+
+// the hold model of a discrete event simulation: each step takes the
+// earliest event and schedules it again some time later
+template <typename Heap>
+std::uint64_t hold_test(Heap &heap) {
+    std::uint64_t checksum = 0;
+
+    for (std::uint32_t i = 0; i < HOLD_EVENTS; ++i) {
+        heap.push(EventT{ hold_delay(EventT{ 0, i }), i });
+    }
+
+    for (std::size_t i = 0; i < HOLD_STEPS; ++i) {
+        const EventT event = heap.top();
+        heap.pop();
+
+        checksum += event.first;
+        heap.push(EventT{ event.first + hold_delay(event), event.second });
+    }
+
+    while (not heap.empty()) {
+        heap.pop();
+    }
+
+    return checksum;
+}
+
+constexpr std::uint32_t TIMER_CONNECTIONS = 1 << 21;
+constexpr std::uint64_t TIMER_TICKS = 1 << 10;
+constexpr std::size_t TIMER_TOUCHES = 1 << 12;
+constexpr std::uint64_t TIMER_TIMEOUT = 1 << 16;
+
+struct WheelConnection : gregjm::TimerNode {
+    std::uint32_t id;
+};
+
+struct HeapTimer {
+    std::uint64_t deadline;
+    std::uint32_t id;
+};
+
+struct TimerLater {
+    bool operator()(const HeapTimer &lhs, const HeapTimer &rhs) const noexcept {
+        return lhs.deadline > rhs.deadline;
+    }
+};
+
+// depends only on the connection and the time, so both schedulers see the
+// same timeouts whatever order they expire things in
+std::uint64_t timer_delay(const std::uint32_t id,
+                          const std::uint64_t now) noexcept {
+    return hold_delay(EventT{ now, id }) % TIMER_TIMEOUT + 1;
+}
+
+// every connection has a timeout pending. each tick some of them see
+// traffic and push theirs back, then the ones that expired start over
+std::uint64_t wheel_timer_test(gregjm::PolymorphicAllocator &alloc) {
+    using AdaptorT = gregjm::PolymorphicAllocatorAdaptor<WheelConnection>;
+
+    std::vector<WheelConnection, AdaptorT> connections(
+        TIMER_CONNECTIONS, AdaptorT{ alloc }
+    );
+    gregjm::HierarchicalTimingWheel<> wheel;
+    std::mt19937 engine{ 0x5eed };
+    std::uniform_int_distribution<std::uint32_t> touched{
+        0, TIMER_CONNECTIONS - 1
+    };
+    std::uint64_t num_expired = 0;
+
+    for (std::uint32_t id = 0; id < TIMER_CONNECTIONS; ++id) {
+        connections[id].id = id;
+        wheel.schedule(connections[id], timer_delay(id, 0));
+    }
+
+    for (std::uint64_t tick = 0; tick < TIMER_TICKS; ++tick) {
+        for (std::size_t i = 0; i < TIMER_TOUCHES; ++i) {
+            const std::uint32_t id = touched(engine);
+
+            wheel.reschedule(connections[id],
+                             wheel.now() + timer_delay(id, wheel.now()));
+        }
+
+        num_expired += wheel.advance(1, [&wheel](gregjm::TimerNode &node) {
+            auto &connection = static_cast<WheelConnection&>(node);
+
+            wheel.schedule(connection,
+                           wheel.now() + timer_delay(connection.id,
+                                                     wheel.now()));
+        });
+    }
+
+    for (WheelConnection &connection : connections) {
+        wheel.cancel(connection);
+    }
+
+    return num_expired;
+}
+
+std::uint64_t heap_timer_test() {
+    using HeapT = gregjm::FibonacciHeap<HeapTimer, TimerLater>;
+
+    HeapT heap;
+    std::vector<HeapT::iterator> handles(TIMER_CONNECTIONS);
+    std::mt19937 engine{ 0x5eed };
+    std::uniform_int_distribution<std::uint32_t> touched{
+        0, TIMER_CONNECTIONS - 1
+    };
+    std::uint64_t now = 0;
+    std::uint64_t num_expired = 0;
+
+    for (std::uint32_t id = 0; id < TIMER_CONNECTIONS; ++id) {
+        handles[id] = heap.push(HeapTimer{ timer_delay(id, 0), id });
+    }
+
+    for (std::uint64_t tick = 0; tick < TIMER_TICKS; ++tick) {
+        for (std::size_t i = 0; i < TIMER_TOUCHES; ++i) {
+            const std::uint32_t id = touched(engine);
+            const std::uint64_t deadline = now + timer_delay(id, now);
+
+            heap.update(handles[id], [deadline](HeapTimer &timer) {
+                timer.deadline = deadline;
+            });
+        }
+
+        ++now;
+
+        while (heap.top().deadline <= now) {
+            const std::uint32_t id = heap.top().id;
+            heap.pop();
+
+            handles[id] = heap.push(HeapTimer{ now + timer_delay(id, now),
+                                               id });
+            ++num_expired;
+        }
+    }
+
+    return num_expired;
+}
+
+constexpr std::size_t BATCH_SIZE = 64;
+constexpr std::size_t BATCH_ROUNDS = 1 << 15;
+constexpr std::size_t BATCH_BACKLOG = 1 << 16;
+
+// a scheduler that keeps a backlog of work, takes a batch of the most
+// urgent items each round and gets a batch of new ones back
+template <bool Batched>
+std::uint64_t batch_test() {
+    gregjm::FibonacciHeap<std::uint32_t> heap;
+    std::mt19937 engine{ 0x5eed };
+    std::vector<std::uint32_t> incoming(BATCH_SIZE);
+    std::vector<std::uint32_t> taken;
+    std::uint64_t checksum = 0;
+
+    taken.reserve(BATCH_SIZE);
+
+    for (std::size_t i = 0; i < BATCH_BACKLOG; ++i) {
+        heap.push(static_cast<std::uint32_t>(engine()));
+    }
+
+    for (std::size_t round = 0; round < BATCH_ROUNDS; ++round) {
+        std::generate(incoming.begin(), incoming.end(), std::ref(engine));
+
+        if constexpr (Batched) {
+            heap.push_batch(incoming.cbegin(), incoming.cend());
+            heap.pop_k(BATCH_SIZE, std::back_inserter(taken));
+        } else {
+            for (const std::uint32_t priority : incoming) {
+                heap.push(priority);
+            }
+
+            for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+                taken.push_back(heap.top());
+                heap.pop();
+            }
+        }
+
+        checksum += std::accumulate(taken.cbegin(), taken.cend(),
+                                    std::uint64_t{ 0 });
+        taken.clear();
+    }
+
+    return checksum;
+}
+
+constexpr std::size_t TOP_K_STREAM = 1 << 23;
+constexpr std::size_t TOP_K = 1 << 10;
+
+// the best TOP_K of a stream of scores, kept as they arrive
+std::uint64_t bounded_top_k_test() {
+    gregjm::BoundedHeap<std::uint32_t> heap{ TOP_K };
+    std::mt19937 engine{ 0x5eed };
+    std::vector<std::uint32_t> best;
+
+    for (std::size_t i = 0; i < TOP_K_STREAM; ++i) {
+        heap.push(static_cast<std::uint32_t>(engine()));
+    }
+
+    heap.drain(std::back_inserter(best));
+
+    return std::accumulate(best.cbegin(), best.cend(), std::uint64_t{ 0 });
+}
+
+// the same, keeping the whole stream and taking the best at the end
+std::uint64_t unbounded_top_k_test() {
+    gregjm::FibonacciHeap<std::uint32_t> heap;
+    std::mt19937 engine{ 0x5eed };
+    std::vector<std::uint32_t> best;
+
+    for (std::size_t i = 0; i < TOP_K_STREAM; ++i) {
+        heap.push(static_cast<std::uint32_t>(engine()));
+    }
+
+    heap.pop_k(TOP_K, std::back_inserter(best));
+
+    return std::accumulate(best.cbegin(), best.cend(), std::uint64_t{ 0 });
+}
+
+constexpr std::uint32_t QUEUED_TASKS = 1 << 20;
+constexpr std::size_t QUEUE_STEPS = 1 << 22;
+
+struct QueuedTask : gregjm::FibonacciHeapHook<> {
+    std::uint32_t priority;
+};
+
+struct TaskLess {
+    bool operator()(const QueuedTask &lhs,
+                    const QueuedTask &rhs) const noexcept {
+        return lhs.priority < rhs.priority;
+    }
+};
+
+struct TaskEntry {
+    std::uint32_t priority;
+    std::uint32_t id;
+};
+
+struct TaskEntryLess {
+    bool operator()(const TaskEntry &lhs, const TaskEntry &rhs) const noexcept {
+        return lhs.priority < rhs.priority;
+    }
+};
+
+// a run queue: each step runs the most urgent task and requeues it at a
+// new priority, and some other task has its priority changed
+std::uint64_t intrusive_queue_test(gregjm::PolymorphicAllocator &alloc) {
+    using AdaptorT = gregjm::PolymorphicAllocatorAdaptor<QueuedTask>;
+
+    std::vector<QueuedTask, AdaptorT> tasks(QUEUED_TASKS, AdaptorT{ alloc });
+    gregjm::IntrusiveFibonacciHeap<QueuedTask, TaskLess> heap;
+    std::mt19937 engine{ 0x5eed };
+    std::uniform_int_distribution<std::uint32_t> task{
+        0, QUEUED_TASKS - 1
+    };
+    std::uint64_t checksum = 0;
+
+    for (QueuedTask &queued : tasks) {
+        queued.priority = static_cast<std::uint32_t>(engine());
+        heap.push(queued);
+    }
+
+    for (std::size_t i = 0; i < QUEUE_STEPS; ++i) {
+        QueuedTask &top = heap.top();
+        checksum += top.priority;
+        heap.pop();
+        top.priority = static_cast<std::uint32_t>(engine());
+        heap.push(top);
+
+        const std::uint32_t priority = static_cast<std::uint32_t>(engine());
+        heap.update(tasks[task(engine)], [priority](QueuedTask &queued) {
+            queued.priority = priority;
+        });
+    }
+
+    heap.clear();
+
+    return checksum;
+}
+
+template <typename Stats = gregjm::DummyHeapStats>
+std::uint64_t node_queue_test(Stats *const stats = nullptr) {
+    using HeapT = gregjm::FibonacciHeap<TaskEntry, TaskEntryLess,
+                                        std::allocator<TaskEntry>, Stats>;
+
+    HeapT heap;
+    std::vector<typename HeapT::iterator> handles(QUEUED_TASKS);
+    std::mt19937 engine{ 0x5eed };
+    std::uniform_int_distribution<std::uint32_t> task{
+        0, QUEUED_TASKS - 1
+    };
+    std::uint64_t checksum = 0;
+
+    for (std::uint32_t id = 0; id < QUEUED_TASKS; ++id) {
+        handles[id] = heap.push(
+            TaskEntry{ static_cast<std::uint32_t>(engine()), id }
+        );
+    }
+
+    for (std::size_t i = 0; i < QUEUE_STEPS; ++i) {
+        const TaskEntry top = heap.top();
+        checksum += top.priority;
+        heap.pop();
+        handles[top.id] = heap.push(
+            TaskEntry{ static_cast<std::uint32_t>(engine()), top.id }
+        );
+
+        const std::uint32_t priority = static_cast<std::uint32_t>(engine());
+        heap.update(handles[task(engine)], [priority](TaskEntry &entry) {
+            entry.priority = priority;
+        });
+    }
+
+    if (stats) {
+        *stats = heap.stats();
+    }
+
+    return checksum;
+}
+
+// an event whose key is a small part of it
+struct HeavyEvent {
+    std::uint64_t time;
+    std::uint32_t id;
+    std::uint8_t body[116];
+};
+
+struct LaterHeavyEvent {
+    bool operator()(const HeavyEvent &lhs,
+                    const HeavyEvent &rhs) const noexcept {
+        return lhs.time > rhs.time;
+    }
+};
+
+HeavyEvent make_heavy_event(const std::uint64_t time,
+                            const std::uint32_t id) noexcept {
+    HeavyEvent event;
+    event.time = time;
+    event.id = id;
+    std::memset(event.body, static_cast<int>(id), sizeof(event.body));
+
+    return event;
+}
+
+// the hold model again, with events stored whole in each node or split
+// into a key in the heap and a payload beside it
+template <bool Split>
+std::uint64_t heavy_hold_test() {
+    using InlineT = gregjm::FibonacciHeap<HeavyEvent, LaterHeavyEvent>;
+    using SplitT = gregjm::KeyPayloadHeap<std::uint64_t, HeavyEvent,
+                                          std::greater<std::uint64_t>>;
+
+    std::conditional_t<Split, SplitT, InlineT> heap;
+    std::uint64_t checksum = 0;
+
+    const auto push = [&heap](const HeavyEvent &event) {
+        if constexpr (Split) {
+            heap.push(event.time, event);
+        } else {
+            heap.push(event);
+        }
+    };
+
+    for (std::uint32_t i = 0; i < HOLD_EVENTS; ++i) {
+        push(make_heavy_event(hold_delay(EventT{ 0, i }), i));
+    }
+
+    for (std::size_t i = 0; i < HOLD_STEPS; ++i) {
+        HeavyEvent event;
+
+        if constexpr (Split) {
+            event = heap.top_payload();
+        } else {
+            event = heap.top();
+        }
+
+        heap.pop();
+
+        checksum += event.time + event.body[0];
+        event.time += hold_delay(EventT{ event.time, event.id });
+        push(event);
+    }
+
+    return checksum;
+}
+
+constexpr std::uint32_t CANCELLED_TASKS = 1 << 20;
+
+// a scheduler where nine in ten tasks are cancelled before they're due:
+// each step schedules a task, cancels an older one and sometimes runs the
+// next one due
+template <bool Lazy>
+std::uint64_t cancel_test() {
+    using HeapT = gregjm::FibonacciHeap<TaskEntry, TaskEntryLess>;
+
+    HeapT heap;
+    std::vector<HeapT::iterator> handles(CANCELLED_TASKS);
+    std::vector<std::uint32_t> scheduled;
+    std::mt19937 engine{ 0x5eed };
+    std::uint64_t checksum = 0;
+
+    scheduled.reserve(CANCELLED_TASKS);
+
+    for (std::uint32_t id = 0; id < CANCELLED_TASKS; ++id) {
+        handles[id] = heap.push(
+            TaskEntry{ static_cast<std::uint32_t>(engine()), id }
+        );
+        scheduled.push_back(id);
+
+        if (id % 10 == 9) {
+            const TaskEntry top = heap.top();
+            checksum += top.priority;
+            heap.pop();
+            handles[top.id] = HeapT::iterator{ };
+
+            continue;
+        }
+
+        // cancels a random task that's still scheduled; ones that already
+        // ran are dropped from scheduled as they're drawn
+        while (not scheduled.empty()) {
+            const std::size_t index = engine() % scheduled.size();
+            const std::uint32_t victim = scheduled[index];
+            scheduled[index] = scheduled.back();
+            scheduled.pop_back();
+
+            if (handles[victim] == HeapT::iterator{ }) {
+                continue;
+            }
+
+            if (Lazy) {
+                heap.erase_lazily(handles[victim]);
+            } else {
+                heap.erase(handles[victim]);
+            }
+
+            handles[victim] = HeapT::iterator{ };
+
+            break;
+        }
+    }
+
+    while (not heap.empty()) {
+        checksum += heap.top().priority;
+        heap.pop();
+    }
+
+    return checksum;
+}
+
 void wait() {
     char buffer;
 
@@ -316,6 +1178,884 @@ void run_segregating_pool_tests(const std::size_t num_tests) {
         << " seconds\n";
 }
 
+void run_free_list_tests(const std::size_t num_tests) {
+    const std::size_t num_threads =
+        std::max(std::thread::hardware_concurrency(), 2u);
+    long double lock_free_duration = 0;
+    long double locked_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        lock_free_duration +=
+            time(free_list_test<gregjm::LockFreeFreeList>, num_threads).count();
+        locked_duration +=
+            time(free_list_test<LockedFreeList<std::mutex>>,
+                 num_threads).count();
+    }
+
+    std::cerr << "lock-free free list tests took " << lock_free_duration
+        << " seconds\n";
+    std::cerr << "locked free list tests took " << locked_duration
+        << " seconds\n";
+}
+
+void run_ring_tests(const std::size_t num_tests) {
+    const auto ring = std::make_unique<gregjm::RingAllocator<RING_SIZE>>();
+    gregjm::GlobalAllocator<> global;
+    long double ring_duration = 0;
+    long double global_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        ring_duration += time([&ring] { ring_test(*ring); }).count();
+        global_duration += time([&global] { ring_test(global); }).count();
+    }
+
+    std::cerr << "ring tests took " << ring_duration << " seconds\n";
+    std::cerr << "global ring tests took " << global_duration
+        << " seconds\n";
+}
+
+void run_stream_tests(const std::size_t num_tests) {
+    long double mirrored_duration = 0;
+    long double wrapping_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        mirrored_duration += time(mirrored_stream_test).count();
+        wrapping_duration += time(wrapping_stream_test).count();
+    }
+
+    std::cerr << "mirrored stream tests took " << mirrored_duration
+        << " seconds\n";
+    std::cerr << "wrapping stream tests took " << wrapping_duration
+        << " seconds\n";
+}
+
+void run_growth_tests(const std::size_t num_tests) {
+    gregjm::VirtualArena<> arena{ GROWTH_RESERVE };
+    long double arena_duration = 0;
+    long double vector_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        arena_duration +=
+            time([&arena] { arena_growth_test(arena); }).count();
+        vector_duration += time(vector_growth_test).count();
+    }
+
+    std::cerr << "arena growth tests took " << arena_duration
+        << " seconds\n";
+    std::cerr << "vector growth tests took " << vector_duration
+        << " seconds\n";
+}
+
+void run_prefault_tests(const std::size_t num_tests) {
+    long double cold_duration = 0;
+    long double cold_slowest = 0;
+    long double warm_duration = 0;
+    long double warm_slowest = 0;
+    long double reserve_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        PrefaultPoolT cold;
+        cold_duration += time([&cold, &cold_slowest] {
+            cold_slowest += serve_first_requests(cold);
+        }).count();
+
+        PrefaultPoolT warm;
+        reserve_duration += time([&warm] {
+            warm.reserve(PREFAULT_POOLS, gregjm::Prefaulter{ });
+        }).count();
+        warm_duration += time([&warm, &warm_slowest] {
+            warm_slowest += serve_first_requests(warm);
+        }).count();
+    }
+
+    std::cerr << "cold pool requests took " << cold_duration
+        << " seconds, slowest " << cold_slowest / num_tests * 1e6
+        << " us on average\n";
+    std::cerr << "prefaulted pool requests took " << warm_duration
+        << " seconds, slowest " << warm_slowest / num_tests * 1e6
+        << " us on average\n";
+    std::cerr << "prefaulting took " << reserve_duration << " seconds\n";
+}
+
+void run_graph_tests(const std::size_t num_tests) {
+    using PoolT = gregjm::PoolAllocator<128_KiB, gregjm::GlobalAllocator<>>;
+    using PooledEngineT = gregjm::FibonacciEngine<
+        std::uint32_t, gregjm::PolymorphicAllocatorAdaptor<KeyedVertexT>
+    >;
+
+    gregjm::GlobalAllocator<> global;
+    const GraphT directed = make_graph(global, false);
+    const GraphT undirected = make_graph(global, true);
+
+    PoolT pool;
+    gregjm::FibonacciEngine<std::uint32_t> fibonacci;
+    PooledEngineT pooled{ gregjm::make_adaptor<KeyedVertexT>(pool) };
+    gregjm::BinaryHeapEngine<std::uint32_t> binary;
+
+    long double fibonacci_durations[2] = { 0, 0 };
+    long double pooled_durations[2] = { 0, 0 };
+    long double binary_durations[2] = { 0, 0 };
+    std::uint64_t results[3][2];
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        fibonacci_durations[0] += time([&] {
+            results[0][0] = dijkstra_test(directed, fibonacci);
+        }).count();
+        pooled_durations[0] += time([&] {
+            results[1][0] = dijkstra_test(directed, pooled);
+        }).count();
+        binary_durations[0] += time([&] {
+            results[2][0] = dijkstra_test(directed, binary);
+        }).count();
+
+        fibonacci_durations[1] += time([&] {
+            results[0][1] = prim_test(undirected, fibonacci);
+        }).count();
+        pooled_durations[1] += time([&] {
+            results[1][1] = prim_test(undirected, pooled);
+        }).count();
+        binary_durations[1] += time([&] {
+            results[2][1] = prim_test(undirected, binary);
+        }).count();
+    }
+
+    for (std::size_t i = 0; i < 2 and num_tests != 0; ++i) {
+        if (results[0][i] != results[1][i] or results[0][i] != results[2][i]) {
+            std::cerr << "graph engines disagree\n";
+        }
+    }
+
+    std::cerr << "fibonacci dijkstra tests took " << fibonacci_durations[0]
+        << " seconds\n";
+    std::cerr << "pooled fibonacci dijkstra tests took "
+        << pooled_durations[0] << " seconds\n";
+    std::cerr << "binary heap dijkstra tests took " << binary_durations[0]
+        << " seconds\n";
+    std::cerr << "fibonacci prim tests took " << fibonacci_durations[1]
+        << " seconds\n";
+    std::cerr << "pooled fibonacci prim tests took " << pooled_durations[1]
+        << " seconds\n";
+    std::cerr << "binary heap prim tests took " << binary_durations[1]
+        << " seconds\n";
+}
+
+void run_radix_tests(const std::size_t num_tests) {
+    using FibonacciT = gregjm::FibonacciHeap<EventT, std::greater<EventT>>;
+    using RadixT = gregjm::RadixHeap<std::uint64_t, std::uint32_t>;
+    using AdaptedRadixT = gregjm::RadixHeap<
+        std::uint64_t, std::uint32_t,
+        gregjm::PolymorphicAllocatorAdaptor<EventT>
+    >;
+    using EntryT = std::pair<std::uint32_t, gregjm::VertexId>;
+    using AdaptedEngineT = gregjm::RadixHeapEngine<
+        std::uint32_t, gregjm::PolymorphicAllocatorAdaptor<EntryT>
+    >;
+
+    gregjm::GlobalAllocator<> global;
+    const GraphT directed = make_graph(global, false);
+
+    FibonacciT fibonacci_heap;
+    RadixT radix_heap;
+    AdaptedRadixT adapted_heap{ gregjm::make_adaptor<EventT>(global) };
+    gregjm::FibonacciEngine<std::uint32_t> fibonacci_engine;
+    gregjm::RadixHeapEngine<std::uint32_t> radix_engine;
+    AdaptedEngineT adapted_engine{
+        gregjm::make_adaptor<EntryT>(global)
+    };
+
+    long double fibonacci_durations[2] = { 0, 0 };
+    long double radix_durations[2] = { 0, 0 };
+    long double adapted_durations[2] = { 0, 0 };
+    std::uint64_t results[3][2];
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        fibonacci_durations[0] += time([&] {
+            results[0][0] = hold_test(fibonacci_heap);
+        }).count();
+        radix_durations[0] += time([&] {
+            results[1][0] = hold_test(radix_heap);
+            radix_heap.clear();
+        }).count();
+        adapted_durations[0] += time([&] {
+            results[2][0] = hold_test(adapted_heap);
+            adapted_heap.clear();
+        }).count();
+
+        fibonacci_durations[1] += time([&] {
+            results[0][1] = dijkstra_test(directed, fibonacci_engine);
+        }).count();
+        radix_durations[1] += time([&] {
+            results[1][1] = dijkstra_test(directed, radix_engine);
+        }).count();
+        adapted_durations[1] += time([&] {
+            results[2][1] = dijkstra_test(directed, adapted_engine);
+        }).count();
+    }
+
+    for (std::size_t i = 0; i < 2 and num_tests != 0; ++i) {
+        if (results[0][i] != results[1][i] or results[0][i] != results[2][i]) {
+            std::cerr << "heaps disagree\n";
+        }
+    }
+
+    std::cerr << "fibonacci hold tests took " << fibonacci_durations[0]
+        << " seconds\n";
+    std::cerr << "radix hold tests took " << radix_durations[0]
+        << " seconds\n";
+    std::cerr << "adapted radix hold tests took " << adapted_durations[0]
+        << " seconds\n";
+    std::cerr << "fibonacci dijkstra tests took " << fibonacci_durations[1]
+        << " seconds\n";
+    std::cerr << "radix dijkstra tests took " << radix_durations[1]
+        << " seconds\n";
+    std::cerr << "adapted radix dijkstra tests took " << adapted_durations[1]
+        << " seconds\n";
+}
+
+void run_timer_tests(const std::size_t num_tests) {
+    gregjm::VirtualArena<> slab{
+        sizeof(WheelConnection) * TIMER_CONNECTIONS
+    };
+    long double wheel_duration = 0;
+    long double heap_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        wheel_duration += time([&] {
+            results[0] = wheel_timer_test(slab);
+        }).count();
+        heap_duration += time([&] {
+            results[1] = heap_timer_test();
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "timer schedulers disagree\n";
+    }
+
+    std::cerr << "timing wheel tests took " << wheel_duration
+        << " seconds\n";
+    std::cerr << "fibonacci heap timer tests took " << heap_duration
+        << " seconds\n";
+}
+
+void run_batch_tests(const std::size_t num_tests) {
+    long double batched_duration = 0;
+    long double single_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        batched_duration += time([&results] {
+            results[0] = batch_test<true>();
+        }).count();
+        single_duration += time([&results] {
+            results[1] = batch_test<false>();
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "batched and single heap operations disagree\n";
+    }
+
+    std::cerr << "batched heap tests took " << batched_duration
+        << " seconds\n";
+    std::cerr << "single heap tests took " << single_duration
+        << " seconds\n";
+}
+
+void run_top_k_tests(const std::size_t num_tests) {
+    long double bounded_duration = 0;
+    long double unbounded_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        bounded_duration += time([&results] {
+            results[0] = bounded_top_k_test();
+        }).count();
+        unbounded_duration += time([&results] {
+            results[1] = unbounded_top_k_test();
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "top k heaps disagree\n";
+    }
+
+    std::cerr << "bounded top k tests took " << bounded_duration
+        << " seconds\n";
+    std::cerr << "unbounded top k tests took " << unbounded_duration
+        << " seconds\n";
+}
+
+void run_intrusive_tests(const std::size_t num_tests) {
+    gregjm::VirtualArena<> arena{ sizeof(QueuedTask) * QUEUED_TASKS };
+    long double intrusive_duration = 0;
+    long double node_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        intrusive_duration += time([&arena] {
+            intrusive_queue_test(arena);
+        }).count();
+        node_duration += time([] { node_queue_test(); }).count();
+    }
+
+    std::cerr << "intrusive heap tests took " << intrusive_duration
+        << " seconds\n";
+    std::cerr << "node heap tests took " << node_duration << " seconds\n";
+}
+
+void run_cancel_tests(const std::size_t num_tests) {
+    long double lazy_duration = 0;
+    long double eager_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        lazy_duration += time([&results] {
+            results[0] = cancel_test<true>();
+        }).count();
+        eager_duration += time([&results] {
+            results[1] = cancel_test<false>();
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "lazy and eager erasure disagree\n";
+    }
+
+    std::cerr << "lazy erase tests took " << lazy_duration << " seconds\n";
+    std::cerr << "eager erase tests took " << eager_duration
+        << " seconds\n";
+}
+
+void run_split_tests(const std::size_t num_tests) {
+    long double split_duration = 0;
+    long double inline_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        split_duration += time([&results] {
+            results[0] = heavy_hold_test<true>();
+        }).count();
+        inline_duration += time([&results] {
+            results[1] = heavy_hold_test<false>();
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "split and inline heaps disagree\n";
+    }
+
+    std::cerr << "split key/payload heap tests took " << split_duration
+        << " seconds\n";
+    std::cerr << "inline heap tests took " << inline_duration
+        << " seconds\n";
+}
+
+// how much counting costs, and what the run queue workload does
+void run_heap_stats_tests(const std::size_t num_tests) {
+    long double counted_duration = 0;
+    long double uncounted_duration = 0;
+    gregjm::HeapStats stats;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        counted_duration += time([&stats] {
+            node_queue_test(&stats);
+        }).count();
+        uncounted_duration += time([] { node_queue_test(); }).count();
+    }
+
+    std::cerr << "counted heap tests took " << counted_duration
+        << " seconds\n";
+    std::cerr << "uncounted heap tests took " << uncounted_duration
+        << " seconds\n";
+    std::cerr << "each run made " << stats.comparisons << " comparisons, "
+        << stats.links << " links, " << stats.consolidations
+        << " consolidations of up to " << stats.max_root_list
+        << " trees, " << stats.cascading_cuts << " cascading cuts and "
+        << stats.allocations << " allocations\n";
+}
+
+#if defined(__linux__)
+constexpr char DIRECT_IO_FILE[] = "direct_io_test.bin";
+constexpr std::size_t DIRECT_IO_FILE_SIZE = 256_MiB;
+constexpr std::size_t DIRECT_IO_BUFFER_SIZE = 1_MiB;
+
+bool make_direct_io_file() {
+    const int fd = open(DIRECT_IO_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    std::vector<char> buffer(DIRECT_IO_BUFFER_SIZE, 'x');
+    bool ok = true;
+
+    for (std::size_t written = 0; ok and written < DIRECT_IO_FILE_SIZE;
+         written += buffer.size()) {
+        ok = write(fd, buffer.data(), buffer.size())
+             == static_cast<ssize_t>(buffer.size());
+    }
+
+    ok = ok and fsync(fd) == 0;
+    close(fd);
+
+    return ok;
+}
+
+// one buffer per read, as a request handler would use them
+void direct_io_read_test(gregjm::DirectIoBufferPool<> &pool, const int fd) {
+    for (std::size_t offset = 0; offset < DIRECT_IO_FILE_SIZE;
+         offset += DIRECT_IO_BUFFER_SIZE) {
+        const gregjm::MemoryBlock buffer =
+            pool.allocate(DIRECT_IO_BUFFER_SIZE, pool.alignment());
+
+        if (pread(fd, buffer.memory, buffer.size, static_cast<off_t>(offset))
+            != static_cast<ssize_t>(buffer.size)) {
+            std::cerr << "direct read failed\n";
+        }
+
+        pool.deallocate(buffer);
+    }
+}
+
+void buffered_read_test(const int fd) {
+    // read from the disk, not the page cache
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    for (std::size_t offset = 0; offset < DIRECT_IO_FILE_SIZE;
+         offset += DIRECT_IO_BUFFER_SIZE) {
+        void *const buffer = std::malloc(DIRECT_IO_BUFFER_SIZE);
+
+        if (pread(fd, buffer, DIRECT_IO_BUFFER_SIZE, static_cast<off_t>(offset))
+            != static_cast<ssize_t>(DIRECT_IO_BUFFER_SIZE)) {
+            std::cerr << "buffered read failed\n";
+        }
+
+        std::free(buffer);
+    }
+}
+
+constexpr std::size_t SPLICE_RESPONSE_SIZE = 1_MiB;
+constexpr std::size_t SPLICE_RESPONSES = 256;
+
+// builds responses in an arena and sends each one down a pipe, either by
+// copying it with write or by gifting its pages with export_to, while
+// another thread drains the pipe into /dev/null
+template <bool Export>
+void splice_test() {
+    int pipe_fds[2];
+
+    if (pipe(pipe_fds) != 0) {
+        std::cerr << "couldn't open a pipe\n";
+
+        return;
+    }
+
+    const int null_fd = open("/dev/null", O_WRONLY);
+    const std::size_t total = SPLICE_RESPONSE_SIZE * SPLICE_RESPONSES;
+
+    std::thread reader{ [&pipe_fds, null_fd, total] {
+        std::size_t drained = 0;
+
+        while (drained < total) {
+            const std::size_t moved =
+                gregjm::splice_to(pipe_fds[0], null_fd, total - drained);
+
+            if (moved == 0) {
+                break;
+            }
+
+            drained += moved;
+        }
+    } };
+
+    gregjm::SpliceArena<> arena{ SPLICE_RESPONSE_SIZE };
+
+    for (std::size_t i = 0; i < SPLICE_RESPONSES; ++i) {
+        const gregjm::MemoryBlock response =
+            arena.allocate(SPLICE_RESPONSE_SIZE, 1);
+        std::memset(response.memory, static_cast<int>(i), response.size);
+
+        if constexpr (Export) {
+            arena.export_to(pipe_fds[1], response);
+        } else {
+            auto *const bytes = static_cast<const char*>(response.memory);
+
+            for (std::size_t written = 0; written < response.size; ) {
+                const ssize_t result = write(pipe_fds[1], bytes + written,
+                                             response.size - written);
+
+                if (result <= 0) {
+                    break;
+                }
+
+                written += static_cast<std::size_t>(result);
+            }
+        }
+
+        arena.deallocate(response);
+    }
+
+    close(pipe_fds[1]);
+    reader.join();
+    close(pipe_fds[0]);
+    close(null_fd);
+}
+
+void run_splice_tests(const std::size_t num_tests) {
+    long double export_duration = 0;
+    long double write_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        export_duration += time(splice_test<true>).count();
+        write_duration += time(splice_test<false>).count();
+    }
+
+    std::cerr << "exported responses took " << export_duration
+        << " seconds\n";
+    std::cerr << "written responses took " << write_duration
+        << " seconds\n";
+}
+
+constexpr std::size_t CHECKPOINT_STATE_SIZE = 256_MiB;
+constexpr std::size_t CHECKPOINT_WRITES = 1 << 12;
+
+// scribbles on scattered words of the state, as a long-running service
+// would between checkpoints
+void scatter_writes(std::uint64_t *const state, std::mt19937 &engine) {
+    std::uniform_int_distribution<std::size_t> distribution{
+        0, CHECKPOINT_STATE_SIZE / sizeof(std::uint64_t) - 1
+    };
+
+    for (std::size_t i = 0; i < CHECKPOINT_WRITES; ++i) {
+        ++state[distribution(engine)];
+    }
+}
+
+void snapshot_checkpoint_test(gregjm::SnapshotArena<> &arena,
+                              std::uint64_t *const state,
+                              std::mt19937 &engine) {
+    scatter_writes(state, engine);
+
+    {
+        const gregjm::ArenaSnapshot snapshot = arena.snapshot();
+        static_cast<const volatile std::uint8_t*>(
+            snapshot.memory().memory
+        )[0];
+    }
+
+    arena.compact();
+}
+
+void copy_checkpoint_test(std::uint64_t *const state, std::mt19937 &engine) {
+    scatter_writes(state, engine);
+
+    const auto copy =
+        std::make_unique<std::uint64_t[]>(CHECKPOINT_STATE_SIZE
+                                          / sizeof(std::uint64_t));
+    std::memcpy(copy.get(), state, CHECKPOINT_STATE_SIZE);
+    static_cast<volatile std::uint64_t*>(copy.get())[0];
+}
+
+void run_snapshot_tests(const std::size_t num_tests) {
+    gregjm::SnapshotArena<> arena{ CHECKPOINT_STATE_SIZE };
+    auto *const arena_state = static_cast<std::uint64_t*>(
+        arena.allocate(CHECKPOINT_STATE_SIZE, alignof(std::uint64_t)).memory
+    );
+    const auto copied_state =
+        std::make_unique<std::uint64_t[]>(CHECKPOINT_STATE_SIZE
+                                          / sizeof(std::uint64_t));
+
+    std::memset(arena_state, 1, CHECKPOINT_STATE_SIZE);
+    std::memset(copied_state.get(), 1, CHECKPOINT_STATE_SIZE);
+    arena.compact();
+
+    std::mt19937 engine{ 0 };
+    long double snapshot_duration = 0;
+    long double copy_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        snapshot_duration += time(snapshot_checkpoint_test, arena,
+                                  arena_state, engine).count();
+        copy_duration += time(copy_checkpoint_test, copied_state.get(),
+                              engine).count();
+    }
+
+    std::cerr << "snapshot checkpoints took " << snapshot_duration
+        << " seconds\n";
+    std::cerr << "copied checkpoints took " << copy_duration
+        << " seconds\n";
+}
+
+constexpr char RELOCATABLE_FILE[] = "relocatable_test.bin";
+constexpr std::size_t RELOCATABLE_BUCKETS = 1 << 16;
+constexpr std::size_t RELOCATABLE_KEYS = 1 << 20;
+
+// a chained hash table of the sort that's worth building ahead of time
+struct TableNode {
+    TableNode *next;
+    std::uint64_t key;
+    std::uint64_t value;
+};
+
+struct Table {
+    TableNode *buckets[RELOCATABLE_BUCKETS];
+};
+
+std::uint64_t table_key(const std::size_t i) noexcept {
+    return static_cast<std::uint64_t>(i) * 0x9e3779b97f4a7c15ull;
+}
+
+Table* build_table(gregjm::RelocatableArena<> &arena) {
+    auto *const table = new (arena.allocate(sizeof(Table),
+                                            alignof(Table)).memory) Table{ };
+    arena.set_root(table);
+
+    for (TableNode *&bucket : table->buckets) {
+        arena.register_pointer(bucket);
+    }
+
+    for (std::size_t i = 0; i < RELOCATABLE_KEYS; ++i) {
+        const std::uint64_t key = table_key(i);
+        TableNode *&bucket = table->buckets[key % RELOCATABLE_BUCKETS];
+        auto *const node = new (arena.allocate(sizeof(TableNode),
+                                               alignof(TableNode)).memory)
+            TableNode{ nullptr, key, i };
+
+        arena.store_pointer(node->next, bucket);
+        bucket = node;
+    }
+
+    return table;
+}
+
+std::uint64_t probe_table(const Table &table) {
+    std::uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < RELOCATABLE_KEYS; i += 64) {
+        const std::uint64_t key = table_key(i);
+
+        for (const TableNode *node = table.buckets[key % RELOCATABLE_BUCKETS];
+             node; node = node->next) {
+            if (node->key == key) {
+                sum += node->value;
+
+                break;
+            }
+        }
+    }
+
+    return sum;
+}
+
+void rebuild_table_test() {
+    gregjm::RelocatableArena<> arena{
+        sizeof(Table) + RELOCATABLE_KEYS * sizeof(TableNode)
+    };
+
+    static_cast<void>(probe_table(*build_table(arena)));
+}
+
+// the original arena stays mapped, so every pointer has to be fixed up
+void load_table_test() {
+    const gregjm::MappedArena arena =
+        gregjm::MappedArena::load(RELOCATABLE_FILE);
+
+    static_cast<void>(probe_table(*arena.root<Table>()));
+}
+
+void run_relocatable_tests(const std::size_t num_tests) {
+    gregjm::RelocatableArena<> arena{
+        sizeof(Table) + RELOCATABLE_KEYS * sizeof(TableNode)
+    };
+    const std::uint64_t expected = probe_table(*build_table(arena));
+
+    if (not arena.save(RELOCATABLE_FILE)) {
+        std::cerr << "couldn't write " << RELOCATABLE_FILE << '\n';
+
+        return;
+    }
+
+    const gregjm::MappedArena check =
+        gregjm::MappedArena::load(RELOCATABLE_FILE);
+
+    if (not check or probe_table(*check.root<Table>()) != expected) {
+        std::cerr << "loaded table doesn't match\n";
+    }
+
+    long double rebuild_duration = 0;
+    long double load_duration = 0;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        rebuild_duration += time(rebuild_table_test).count();
+        load_duration += time(load_table_test).count();
+    }
+
+    std::cerr << "rebuilt tables took " << rebuild_duration << " seconds\n";
+    std::cerr << "loaded tables took " << load_duration << " seconds\n";
+
+    unlink(RELOCATABLE_FILE);
+}
+
+constexpr std::size_t TIERED_STATE_SIZE = 256_MiB;
+constexpr std::size_t TIERED_READS = 1 << 12;
+
+// the occasional lookup into rarely used state
+std::uint64_t sparse_reads(const std::uint64_t *const state,
+                           std::mt19937 &engine) {
+    std::uniform_int_distribution<std::size_t> distribution{
+        0, TIERED_STATE_SIZE / sizeof(std::uint64_t) - 1
+    };
+    std::uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < TIERED_READS; ++i) {
+        sum += state[distribution(engine)];
+    }
+
+    return sum;
+}
+
+void run_tiered_tests(const std::size_t num_tests) {
+    gregjm::TieredArena<> arena{ TIERED_STATE_SIZE };
+    auto *const state = static_cast<std::uint64_t*>(
+        arena.allocate(TIERED_STATE_SIZE, alignof(std::uint64_t)).memory
+    );
+    std::iota(state, state + TIERED_STATE_SIZE / sizeof(std::uint64_t),
+              std::uint64_t{ 0 });
+
+    std::mt19937 engine{ generator() };
+    long double cold_duration = 0;
+    long double cold_read_duration = 0;
+    long double hot_duration = 0;
+    long double hot_read_duration = 0;
+    volatile std::uint64_t sink = 0;
+    bool failed = false;
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        cold_duration += time([&arena, &failed] {
+            failed = not arena.make_cold() or failed;
+        }).count();
+        cold_read_duration += time([state, &engine, &sink] {
+            sink = sparse_reads(state, engine);
+        }).count();
+        hot_duration += time([&arena] { arena.make_hot(); }).count();
+        hot_read_duration += time([state, &engine, &sink] {
+            sink = sparse_reads(state, engine);
+        }).count();
+    }
+
+    if (failed) {
+        std::cerr << "couldn't write a cold arena\n";
+    }
+
+    std::cerr << "making arenas cold took " << cold_duration << " seconds\n";
+    std::cerr << "reads from cold arenas took " << cold_read_duration
+        << " seconds\n";
+    std::cerr << "making arenas hot took " << hot_duration << " seconds\n";
+    std::cerr << "reads from hot arenas took " << hot_read_duration
+        << " seconds\n";
+}
+
+void run_direct_io_tests(const std::size_t num_tests) {
+    if (not make_direct_io_file()) {
+        std::cerr << "couldn't write " << DIRECT_IO_FILE << '\n';
+
+        return;
+    }
+
+    const int direct_fd = open(DIRECT_IO_FILE, O_RDONLY | O_DIRECT);
+    const int buffered_fd = open(DIRECT_IO_FILE, O_RDONLY);
+
+    if (direct_fd < 0 or buffered_fd < 0) {
+        std::cerr << "filesystem doesn't support O_DIRECT, skipping\n";
+    } else {
+        gregjm::DirectIoBufferPool<> pool{ DIRECT_IO_BUFFER_SIZE, direct_fd };
+        long double direct_duration = 0;
+        long double buffered_duration = 0;
+
+        for (std::size_t i = 0; i < num_tests; ++i) {
+            direct_duration +=
+                time(direct_io_read_test, pool, direct_fd).count();
+            buffered_duration += time(buffered_read_test, buffered_fd).count();
+        }
+
+        const long double mebibytes =
+            static_cast<long double>(num_tests * DIRECT_IO_FILE_SIZE) / 1_MiB;
+
+        std::cerr << "direct reads ran at " << mebibytes / direct_duration
+            << " MiB/s\n";
+        std::cerr << "buffered reads ran at " << mebibytes / buffered_duration
+            << " MiB/s\n";
+    }
+
+    if (direct_fd >= 0) {
+        close(direct_fd);
+    }
+
+    if (buffered_fd >= 0) {
+        close(buffered_fd);
+    }
+
+    unlink(DIRECT_IO_FILE);
+}
+
+constexpr std::size_t EXTERNAL_ELEMENTS = 1 << 22;
+constexpr std::size_t EXTERNAL_CAPACITY = 1 << 16;
+
+// pushes everything, then alternates pushes with pops so that elements in
+// memory and on disk are merged, then pops the rest
+template <typename Queue>
+std::uint64_t external_queue_test(Queue &queue) {
+    std::mt19937_64 engine{ 0x5eed };
+    std::uint64_t checksum = 0;
+
+    for (std::size_t i = 0; i < EXTERNAL_ELEMENTS; ++i) {
+        queue.push(engine());
+    }
+
+    for (std::size_t i = 0; i < EXTERNAL_ELEMENTS / 4; ++i) {
+        checksum += queue.top();
+        queue.pop();
+        queue.push(engine());
+    }
+
+    while (not queue.empty()) {
+        checksum ^= queue.top();
+        queue.pop();
+    }
+
+    return checksum;
+}
+
+void run_external_tests(const std::size_t num_tests) {
+    long double external_duration = 0;
+    long double memory_duration = 0;
+    std::uint64_t results[2] = { 0, 0 };
+
+    for (std::size_t i = 0; i < num_tests; ++i) {
+        external_duration += time([&results] {
+            gregjm::ExternalPriorityQueue<std::uint64_t> queue{
+                EXTERNAL_CAPACITY
+            };
+            results[0] = external_queue_test(queue);
+        }).count();
+        memory_duration += time([&results] {
+            gregjm::FibonacciHeap<std::uint64_t> heap;
+            results[1] = external_queue_test(heap);
+        }).count();
+    }
+
+    if (results[0] != results[1]) {
+        std::cerr << "external and in-memory queues disagree\n";
+    }
+
+    std::cerr << "external queue tests took " << external_duration
+        << " seconds\n";
+    std::cerr << "in-memory queue tests took " << memory_duration
+        << " seconds\n";
+}
+#endif
+
 int main() {
     std::ios_base::sync_with_stdio(false);
     std::cin.tie(nullptr);
@@ -326,5 +2066,27 @@ int main() {
     run_pool_tests(NUM_TESTS);
     //run_segregating_pool_tests(NUM_TESTS);
     //run_segregating_tests(NUM_TESTS);
+    //run_free_list_tests(NUM_TESTS);
+    //run_ring_tests(NUM_TESTS);
+    //run_stream_tests(NUM_TESTS);
+    //run_growth_tests(NUM_TESTS);
+    //run_prefault_tests(NUM_TESTS);
+    //run_graph_tests(NUM_TESTS);
+    //run_radix_tests(NUM_TESTS);
+    //run_timer_tests(NUM_TESTS);
+    //run_batch_tests(NUM_TESTS);
+    //run_top_k_tests(NUM_TESTS);
+    //run_intrusive_tests(NUM_TESTS);
+    //run_cancel_tests(NUM_TESTS);
+    //run_heap_stats_tests(NUM_TESTS);
+    //run_split_tests(NUM_TESTS);
+#if defined(__linux__)
+    //run_direct_io_tests(NUM_TESTS);
+    //run_splice_tests(NUM_TESTS);
+    //run_snapshot_tests(NUM_TESTS);
+    //run_relocatable_tests(NUM_TESTS);
+    //run_tiered_tests(NUM_TESTS);
+    //run_external_tests(NUM_TESTS);
+#endif
     //wait();
 }
@@ -0,0 +1,197 @@
+#include "catch.hpp"
+
+#include "timing_wheel.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Timer : gregjm::TimerNode {
+    std::size_t fired = 0;
+    std::uint64_t fired_at = 0;
+};
+
+} // namespace
+
+TEST_CASE("HierarchicalTimingWheel expiry", "[HierarchicalTimingWheel]") {
+    GIVEN("a small wheel with timers on every level") {
+        gregjm::HierarchicalTimingWheel<2, 3> wheel{ 5 };
+        std::vector<Timer> timers(8);
+        const std::uint64_t expiries[] = { 6, 7, 9, 20, 21, 68, 69, 200 };
+
+        for (std::size_t i = 0; i < timers.size(); ++i) {
+            wheel.schedule(timers[i], expiries[i]);
+        }
+
+        THEN("each fires on exactly its tick") {
+            std::size_t total = 0;
+
+            while (not wheel.empty()) {
+                total += wheel.advance(1, [&wheel](gregjm::TimerNode &node) {
+                    Timer &timer = static_cast<Timer&>(node);
+
+                    ++timer.fired;
+                    timer.fired_at = wheel.now();
+                });
+            }
+
+            REQUIRE(total == timers.size());
+
+            for (std::size_t i = 0; i < timers.size(); ++i) {
+                REQUIRE(timers[i].fired == 1);
+                REQUIRE(timers[i].fired_at == expiries[i]);
+                REQUIRE_FALSE(timers[i].is_scheduled());
+            }
+        }
+    } GIVEN("timers that are cancelled or rescheduled") {
+        gregjm::HierarchicalTimingWheel<> wheel;
+        Timer early;
+        Timer late;
+        Timer cancelled;
+
+        wheel.schedule(early, 10);
+        wheel.schedule(late, 10);
+        wheel.schedule(cancelled, 10);
+        wheel.cancel(cancelled);
+        wheel.reschedule(late, 1000);
+
+        THEN("only the ones still scheduled fire, when they're due") {
+            const auto count = [](gregjm::TimerNode &node) {
+                ++static_cast<Timer&>(node).fired;
+            };
+
+            REQUIRE(wheel.size() == 2);
+            REQUIRE(wheel.advance(10, count) == 1);
+            REQUIRE(early.fired == 1);
+            REQUIRE(wheel.advance(989, count) == 0);
+            REQUIRE(wheel.advance(1, count) == 1);
+            REQUIRE(late.fired == 1);
+            REQUIRE(cancelled.fired == 0);
+        }
+    } GIVEN("a timer past the top level's range") {
+        gregjm::HierarchicalTimingWheel<2, 2> wheel;
+        Timer timer;
+
+        wheel.schedule(timer, 1000);
+
+        THEN("it waits for as many turns as it needs") {
+            const auto count = [](gregjm::TimerNode &node) {
+                ++static_cast<Timer&>(node).fired;
+            };
+
+            REQUIRE(wheel.advance(999, count) == 0);
+            REQUIRE(wheel.advance(1, count) == 1);
+            REQUIRE(timer.fired == 1);
+        }
+    }
+}
+
+TEST_CASE("HierarchicalTimingWheel callbacks", "[HierarchicalTimingWheel]") {
+    GIVEN("timers that reschedule themselves and cancel each other") {
+        gregjm::HierarchicalTimingWheel<3, 3> wheel;
+        std::vector<Timer> timers(1000);
+        std::uint64_t state = 1;
+
+        const auto next = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+            return state >> 33;
+        };
+
+        for (Timer &timer : timers) {
+            wheel.schedule(timer, 1 + next() % 2000);
+        }
+
+        THEN("every timer fires on its tick") {
+            std::size_t fired = 0;
+
+            while (wheel.now() < 10000) {
+                fired += wheel.advance(1, [&](gregjm::TimerNode &node) {
+                    Timer &timer = static_cast<Timer&>(node);
+
+                    REQUIRE(timer.expiry() == wheel.now());
+
+                    ++timer.fired;
+
+                    // other timers in this tick's batch may be cancelled
+                    Timer &other = timers[next() % timers.size()];
+
+                    if (other.is_scheduled() and next() % 4 == 0) {
+                        wheel.cancel(other);
+                    }
+
+                    if (next() % 8 != 0) {
+                        wheel.schedule(timer, wheel.now() + next() % 2000);
+                    }
+                });
+            }
+
+            std::size_t total = 0;
+            std::size_t scheduled = 0;
+
+            for (const Timer &timer : timers) {
+                total += timer.fired;
+
+                if (timer.is_scheduled()) {
+                    REQUIRE(timer.expiry() > wheel.now());
+                    ++scheduled;
+                }
+            }
+
+            REQUIRE(total == fired);
+            REQUIRE(scheduled == wheel.size());
+            REQUIRE(fired > timers.size());
+        }
+    }
+}
+
+TEST_CASE("HierarchicalTimingWheel callbacks that throw",
+          "[HierarchicalTimingWheel]") {
+    GIVEN("three timers due on the same tick") {
+        gregjm::HierarchicalTimingWheel<3, 3> wheel;
+        std::vector<Timer> timers(3);
+
+        for (Timer &timer : timers) {
+            wheel.schedule(timer, 5);
+        }
+
+        const auto throw_on_first = [](gregjm::TimerNode &node) {
+            Timer &timer = static_cast<Timer&>(node);
+            ++timer.fired;
+
+            throw std::runtime_error{ "expiry failed" };
+        };
+
+        REQUIRE_THROWS_AS(wheel.advance(10, throw_on_first),
+                          std::runtime_error);
+
+        THEN("the rest stay scheduled and fire first on the next tick") {
+            REQUIRE(wheel.now() == 5);
+            REQUIRE(wheel.size() == 2);
+            REQUIRE(timers[0].fired == 1);
+            REQUIRE_FALSE(timers[0].is_scheduled());
+            REQUIRE(timers[1].is_scheduled());
+            REQUIRE(timers[2].is_scheduled());
+
+            Timer later;
+            wheel.schedule(later, 6);
+
+            std::vector<Timer*> order;
+
+            REQUIRE(wheel.advance(1, [&order](gregjm::TimerNode &node) {
+                order.push_back(&static_cast<Timer&>(node));
+            }) == 3);
+            REQUIRE(order == std::vector<Timer*>{ &timers[1], &timers[2],
+                                                  &later });
+            REQUIRE(wheel.empty());
+        } AND_THEN("they can still be cancelled") {
+            wheel.cancel(timers[1]);
+            wheel.cancel(timers[2]);
+
+            REQUIRE(wheel.empty());
+            REQUIRE(wheel.advance(1000, throw_on_first) == 0);
+        }
+    }
+}